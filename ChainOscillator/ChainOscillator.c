@@ -0,0 +1,340 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2026 Slaven Glumac
+ *
+ * Chain of N equal masses connected by springs and dampers. The first mass
+ * is attached to the wall, the last one is coupled to the other subsystem
+ * in the same way as the displacement-to-displacement oscillator:
+ * m x_i'' = c (x_{i-1} - x_i) + d (v_{i-1} - v_i) + c (x_{i+1} - x_i) + d (v_{i+1} - v_i)
+ * m x_N'' = c (x_{N-1} - x_N) + d (v_{N-1} - v_N) + ck (xOther - x_N) + dk (vOther - v_N)
+ * with x_0 = v_0 = 0. For N = 1 it is equal to OscillatorD2D.
+ */
+#include <fmi2Functions.h>
+#include <cvode/cvode.h>
+#include <nvector/nvector_serial.h>
+#include <cvode/cvode_band.h>
+#include <sundials/sundials_direct.h>
+#include <sundials/sundials_types.h>
+
+#define MAX_INPUT_DERIVATIVE_ORDER 10
+#define MAX_OUTPUT_DERIVATIVE_ORDER 5
+#define NUMBER_OF_REALS 11
+#define NUMBER_OF_INTEGERS 1
+#define NUMBER_OF_BOOLEANS 0
+#define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_INTERNAL_STATES (_y == NULL ? 0 : (size_t)NV_LENGTH_S(_y))
+#define HAS_INTEGRATOR_STATISTICS 1
+#define HAS_STATE_DERIVATIVE_NORM 1
+
+const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 0};
+
+#define vr_xOther 0
+#define vr_vOther 1
+#define vr_xThis 2
+#define vr_vThis 3
+#define _xOther r(vr_xOther,0)
+#define _vOther r(vr_vOther,0)
+#define _xThis r(vr_xThis,0)
+#define _vThis r(vr_vThis,0)
+#define _m r(4,0)
+#define _c r(5,0)
+#define _d r(6,0)
+#define _ck r(7,0)
+#define _dk r(8,0)
+#define _x0 r(9,0)
+#define _v0 r(10,0)
+#define _N i(11)
+
+/* States are ordered x_1, v_1, x_2, v_2, ..., the Jacobian is banded */
+#define NUMBER_OF_STATES (2 * _N)
+#define UPPER_BANDWIDTH 2
+#define LOWER_BANDWIDTH 3
+#define Jac(i,j) BAND_ELEM(J,i,j)
+
+#define _y _internal.y
+#define _cvode _internal.cvode
+#define _dky _internal.dky
+struct Internal
+{
+    N_Vector y;
+    void* cvode;
+    N_Vector dky;
+};
+
+#include <template.h>
+
+static int f(realtype t, N_Vector y, N_Vector dy, void *user_data)
+{
+    fmi2Component component = user_data;
+    const realtype* x = NV_DATA_S(y);
+    realtype* dx = NV_DATA_S(dy);
+    long int n = NV_LENGTH_S(y);
+    long int k;
+    realtype cm = _c / _m;
+    realtype dm = _d / _m;
+    realtype xLeft = 0.;
+    realtype vLeft = 0.;
+
+    for (k = 0; k < n - 2; k += 2)
+    {
+        dx[k] = x[k + 1];
+        dx[k + 1] = cm * (xLeft - 2. * x[k] + x[k + 2]) + dm * (vLeft - 2. * x[k + 1] + x[k + 3]);
+        xLeft = x[k];
+        vLeft = x[k + 1];
+    }
+    dx[k] = x[k + 1];
+    dx[k + 1] = cm * (xLeft - x[k]) + dm * (vLeft - x[k + 1])
+        + _ck / _m * (interp(component, vr_xOther, t - _t) - x[k])
+        + _dk / _m * (interp(component, vr_vOther, t - _t) - x[k + 1]);
+
+    return CV_SUCCESS;
+}
+
+static int Jacobian(long int N, long int mupper, long int mlower, realtype t, N_Vector y, N_Vector fy, DlsMat J, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3)
+{
+    fmi2Component component = user_data;
+    long int k;
+    realtype cm = _c / _m;
+    realtype dm = _d / _m;
+
+    for (k = 0; k < N; k += 2)
+    {
+        Jac(k, k + 1) = 1.;
+        if (k > 0)
+        {
+            Jac(k + 1, k - 2) = cm;
+            Jac(k + 1, k - 1) = dm;
+        }
+        if (k < N - 2)
+        {
+            Jac(k + 1, k) = -2. * cm;
+            Jac(k + 1, k + 1) = -2. * dm;
+            Jac(k + 1, k + 2) = cm;
+            Jac(k + 1, k + 3) = dm;
+        }
+        else
+        {
+            Jac(k + 1, k) = -cm - _ck / _m;
+            Jac(k + 1, k + 1) = -dm - _dk / _m;
+        }
+    }
+
+    return CV_SUCCESS;
+}
+
+void InstantiateInternal(fmi2Component component)
+{
+    _cvode = CVodeCreate(CV_BDF, CV_NEWTON);
+    _y = NULL;
+    _dky = NULL;
+}
+
+void FreeInternal(fmi2Component component)
+{
+    if (_y != NULL)
+    {
+        N_VDestroy_Serial(_dky);
+        N_VDestroy_Serial(_y);
+    }
+    CVodeFree(&_cvode);
+}
+
+fmi2Status InitializeIntegrator(fmi2Component component)
+{
+    realtype reltol = 1e-8;
+    realtype abstol = 1e-8;
+    if (_toleranceDefined)
+    {
+        reltol = _tolerance;
+        abstol = _tolerance;
+    }
+    logf(fmi2OK, "InitializeIntegrator N = %d", _N);
+    if (CVodeInit(_cvode, f, _t, _y) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVodeSetUserData(_cvode, component) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVodeSStolerances(_cvode, reltol, abstol) != CV_SUCCESS)
+    {
+      return fmi2Error;
+    }
+    if (CVBand(_cvode, NUMBER_OF_STATES, UPPER_BANDWIDTH, LOWER_BANDWIDTH) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVDlsSetBandJacFn(_cvode, Jacobian) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
+
+void StartInitialization(fmi2Component component)
+{
+    _xOther = 0.;
+    _vOther = 0.;
+    _m = 1.;
+    _c = 1.;
+    _d = 1.;
+    _ck = 1.;
+    _dk = 1.;
+    _x0 = 0.1;
+    _v0 = 0.1;
+    _N = 10;
+}
+
+fmi2Status FinishInitialization(fmi2Component component)
+{
+    N_Vector y;
+    long int k;
+    if (_N < 1)
+    {
+        logf(fmi2Error, "N = %d, the chain needs at least one mass!", _N);
+        return fmi2Error;
+    }
+    if (_y != NULL)
+    {
+        N_VDestroy_Serial(_dky);
+        N_VDestroy_Serial(_y);
+    }
+    _y = N_VNew_Serial(NUMBER_OF_STATES);
+    _dky = N_VNew_Serial(NUMBER_OF_STATES);
+    if (_y == NULL || _dky == NULL)
+    {
+        return fmi2Error;
+    }
+    y = _y;
+    for (k = 0; k < NUMBER_OF_STATES; k += 2)
+    {
+        NV_Ith_S(y, k) = _x0;
+        NV_Ith_S(y, k + 1) = _v0;
+    }
+    _xThis = _x0;
+    _vThis = _v0;
+    return InitializeIntegrator(component);
+}
+
+fmi2Status StateUpdate(fmi2Component component, fmi2Real h)
+{
+    N_Vector y = _y;
+    realtype tReached;
+    if (CVodeSetStopTime(_cvode, _t + h) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVode(_cvode, _t + h, _y, &tReached, CV_NORMAL) < 0)
+    {
+        log(fmi2Error, "The integration failed!");
+        return fmi2Error;
+    }
+    _xThis = NV_Ith_S(y, NUMBER_OF_STATES - 2);
+    _vThis = NV_Ith_S(y, NUMBER_OF_STATES - 1);
+    return fmi2OK;
+}
+
+fmi2Status OutputUpdate(fmi2Component component)
+{
+    return fmi2OK;
+}
+
+fmi2Status OutputDerivative(fmi2Component component, fmi2ValueReference vr, fmi2Integer order, fmi2Real* value)
+{
+    N_Vector y = _dky;
+    realtype hLast;
+    int qLast;
+    if (CVodeGetLastStep(_cvode, &hLast) != CV_SUCCESS || hLast == 0.)
+    {
+        log(fmi2Error, "Output derivatives are available after the first step!");
+        return fmi2Error;
+    }
+    if (CVodeGetLastOrder(_cvode, &qLast) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (order > qLast)
+    {
+        *value = 0.;
+        return fmi2OK;
+    }
+    if (CVodeGetDky(_cvode, _t, order, _dky) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    switch (vr)
+    {
+    case vr_xThis:
+        *value = NV_Ith_S(y, NUMBER_OF_STATES - 2);
+        break;
+    case vr_vThis:
+        *value = NV_Ith_S(y, NUMBER_OF_STATES - 1);
+        break;
+    default:
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
+
+fmi2Status IntegratorStatistics(fmi2Component component, struct IntegratorStatistics* statistics)
+{
+    long int linearSolverSetups;
+    int qLast, qCurrent;
+    realtype hInitial, hLast, hCurrent, tCurrent;
+    if (CVodeGetIntegratorStats(_cvode, &statistics->steps, &statistics->rhsEvaluations,
+        &linearSolverSetups, &statistics->errorTestFailures, &qLast, &qCurrent,
+        &hInitial, &hLast, &hCurrent, &tCurrent) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVDlsGetNumJacEvals(_cvode, &statistics->jacobianEvaluations) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVodeGetNumNonlinSolvIters(_cvode, &statistics->newtonIterations) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
+
+fmi2Status StateDerivativeNorm(fmi2Component component, fmi2Real* norm)
+{
+    if (f(_t, _y, _dky, component) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    *norm = N_VMaxNorm(_dky);
+    return fmi2OK;
+}
+
+void SaveInternal(fmi2Component component, fmi2Real state[])
+{
+    N_Vector y = _y;
+    size_t k;
+    for (k = 0; k < NUMBER_OF_INTERNAL_STATES; k++)
+    {
+        state[k] = NV_Ith_S(y, k);
+    }
+}
+
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[])
+{
+    N_Vector y = _y;
+    size_t k;
+    if (y == NULL)
+    {
+        return fmi2OK;
+    }
+    for (k = 0; k < NUMBER_OF_INTERNAL_STATES; k++)
+    {
+        NV_Ith_S(y, k) = state[k];
+    }
+    if (CVodeReInit(_cvode, _t, _y) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
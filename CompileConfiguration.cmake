@@ -0,0 +1,197 @@
+# Compiles a configuration into a plan with all names resolved.
+#
+# cmake -D CONFIGURATION=<configuration.xml> [-D FMU_PATH=<directories>]
+#       [-D CACHE_DIRECTORY=<directory>] [-D FMI_PLATFORM=<platform>]
+#       [-D PACK_PLAN=<PackPlan executable>] [-D OUTPUT=<plan>]
+#       -P CompileConfiguration.cmake
+#
+# Archives are searched in FMU_PATH, which defaults to the directory of the
+# configuration, and extracted into the cache of ExtractArchive.cmake in
+# CACHE_DIRECTORY (the environment variable FMU_CACHE_DIRECTORY or fmus next
+# to OUTPUT by default). The resolved plan is written as text to <OUTPUT>.txt, one tab
+# separated record per line:
+#   instance   name guid modelIdentifier library resources stepRatio flags
+#   parameter  instance type valueReference value
+#   connection type source sourceValueReference destination destinationValueReference
+# where instances are referenced by their index, type is one of the
+# PlanType values and flags a combination of the PlanInstanceFlags from plan.h. With PACK_PLAN the text is packed into the
+# binary plan OUTPUT described by plan.h.
+
+cmake_minimum_required(VERSION 3.5)
+
+include("${CMAKE_CURRENT_LIST_DIR}/ExtractArchive.cmake")
+
+if (NOT DEFINED CONFIGURATION)
+    message(FATAL_ERROR "CONFIGURATION is not set")
+endif()
+get_filename_component(CONFIGURATION "${CONFIGURATION}" ABSOLUTE)
+get_filename_component(configurationDirectory "${CONFIGURATION}" DIRECTORY)
+get_filename_component(configurationName "${CONFIGURATION}" NAME_WE)
+if (NOT DEFINED FMU_PATH)
+    set(FMU_PATH "${configurationDirectory}")
+endif()
+if (NOT DEFINED OUTPUT)
+    set(OUTPUT "${configurationName}.plan")
+endif()
+get_filename_component(OUTPUT "${OUTPUT}" ABSOLUTE)
+if (NOT DEFINED CACHE_DIRECTORY)
+    if (DEFINED ENV{FMU_CACHE_DIRECTORY})
+        set(CACHE_DIRECTORY "$ENV{FMU_CACHE_DIRECTORY}")
+    else()
+        get_filename_component(CACHE_DIRECTORY "${OUTPUT}" DIRECTORY)
+        set(CACHE_DIRECTORY "${CACHE_DIRECTORY}/fmus")
+    endif()
+endif()
+get_filename_component(CACHE_DIRECTORY "${CACHE_DIRECTORY}" ABSOLUTE)
+if (NOT DEFINED FMI_PLATFORM OR FMI_PLATFORM STREQUAL "unknown")
+    if (CMAKE_HOST_WIN32)
+        set(FMI_PLATFORM win64)
+    elseif (CMAKE_HOST_APPLE)
+        set(FMI_PLATFORM darwin64)
+    else()
+        set(FMI_PLATFORM linux64)
+    endif()
+endif()
+if (FMI_PLATFORM MATCHES "^win")
+    set(libraryExtension ".dll")
+elseif (FMI_PLATFORM MATCHES "^darwin")
+    set(libraryExtension ".dylib")
+else()
+    set(libraryExtension ".so")
+endif()
+
+set(typeReal 0)
+set(typeInteger 1)
+set(typeBoolean 2)
+set(typeString 3)
+
+set(flagSource 1)
+set(flagTunable 2)
+
+# Extracts the archive through the cache and reads the value references and types of its
+# variables into <archive>.<variable>.vr and <archive>.<variable>.type
+macro(LoadArchive archive)
+    if (NOT DEFINED "${archive}.modelIdentifier")
+        unset(archivePath)
+        foreach(directory ${FMU_PATH})
+            if (NOT DEFINED archivePath AND EXISTS "${directory}/${archive}")
+                set(archivePath "${directory}/${archive}")
+            endif()
+        endforeach()
+        if (NOT DEFINED archivePath)
+            message(FATAL_ERROR "${archive} is not found in ${FMU_PATH}")
+        endif()
+        ExtractArchive("${archivePath}" "${CACHE_DIRECTORY}" directory)
+        include("${directory}/modelDescription.cmake")
+        if (NOT modelDescription.modelIdentifier)
+            message(FATAL_ERROR "${archive} does not support co-simulation")
+        endif()
+        set("${archive}.guid" "${modelDescription.guid}")
+        set("${archive}.modelIdentifier" "${modelDescription.modelIdentifier}")
+        set("${archive}.library" "${directory}/binaries/${FMI_PLATFORM}/${modelDescription.modelIdentifier}${libraryExtension}")
+        set("${archive}.resources" "file://${directory}/resources")
+        set(source ${flagSource})
+        set(tunable 0)
+        foreach(name ${modelDescription.variables})
+            set("${archive}.${name}.vr" "${modelDescription.${name}.vr}")
+            set("${archive}.${name}.type" "${type${modelDescription.${name}.type}}")
+            if (modelDescription.${name}.causality STREQUAL "input")
+                set(source 0)
+            endif()
+            if (modelDescription.${name}.variability STREQUAL "tunable")
+                set(tunable ${flagTunable})
+            endif()
+        endforeach()
+        math(EXPR "${archive}.flags" "${source} | ${tunable}")
+    endif()
+endmacro()
+
+macro(Resolve archive name)
+    if (NOT DEFINED "${archive}.${name}.vr")
+        message(FATAL_ERROR "${archive} has no variable ${name}")
+    endif()
+    set(vr "${${archive}.${name}.vr}")
+    set(type "${${archive}.${name}.type}")
+endmacro()
+
+macro(Attribute element name)
+    string(REGEX MATCH "[ \t\r\n]${name}=\"([^\"]*)\"" match "${element}")
+    set(${name} "${CMAKE_MATCH_1}")
+endmacro()
+
+file(READ "${CONFIGURATION}" configuration)
+string(REGEX MATCHALL "<(Instance|Archive|Parameter|Source|Destination)[ \t\r\n][^>]*>" elements "${configuration}")
+
+set(plan "${OUTPUT}.txt")
+set(parameters "${OUTPUT}.parameters")
+set(connections "${OUTPUT}.connections")
+file(WRITE "${plan}" "")
+file(WRITE "${parameters}" "")
+file(WRITE "${connections}" "")
+set(numberOfInstances 0)
+
+foreach(element ${elements})
+    if (element MATCHES "^<Instance")
+        Attribute("${element}" instanceName)
+        Attribute("${element}" stepRatio)
+        if (stepRatio STREQUAL "")
+            set(stepRatio 1)
+        elseif (NOT stepRatio MATCHES "^[1-9][0-9]*$")
+            message(FATAL_ERROR "Step ratio of ${instanceName} is not a positive integer")
+        endif()
+        set(instance ${numberOfInstances})
+        math(EXPR numberOfInstances "${numberOfInstances} + 1")
+        set("instance.${instanceName}" ${instance})
+    elseif (element MATCHES "^<Archive")
+        Attribute("${element}" archiveName)
+        LoadArchive("${archiveName}")
+        set("instance.${instanceName}.archive" "${archiveName}")
+        file(APPEND "${plan}" "instance\t${instanceName}\t${${archiveName}.guid}\t${${archiveName}.modelIdentifier}\t${${archiveName}.library}\t${${archiveName}.resources}\t${stepRatio}\t${${archiveName}.flags}\n")
+    elseif (element MATCHES "^<Parameter")
+        Attribute("${element}" name)
+        Attribute("${element}" value)
+        Resolve("${archiveName}" "${name}")
+        if (type EQUAL typeBoolean)
+            if (value STREQUAL "true" OR value STREQUAL "1")
+                set(value 1)
+            else()
+                set(value 0)
+            endif()
+        endif()
+        file(APPEND "${parameters}" "parameter\t${instance}\t${type}\t${vr}\t${value}\n")
+    elseif (element MATCHES "^<Source")
+        Attribute("${element}" instanceName)
+        Attribute("${element}" outputName)
+        if (NOT DEFINED "instance.${instanceName}")
+            message(FATAL_ERROR "Unknown source instance ${instanceName}")
+        endif()
+        set(source "${instance.${instanceName}}")
+        Resolve("${instance.${instanceName}.archive}" "${outputName}")
+        set(sourceVr ${vr})
+        set(sourceType ${type})
+    elseif (element MATCHES "^<Destination")
+        Attribute("${element}" instanceName)
+        Attribute("${element}" inputName)
+        if (NOT DEFINED "instance.${instanceName}")
+            message(FATAL_ERROR "Unknown destination instance ${instanceName}")
+        endif()
+        Resolve("${instance.${instanceName}.archive}" "${inputName}")
+        if (NOT type EQUAL sourceType)
+            message(FATAL_ERROR "${outputName} and ${instanceName}.${inputName} are of different types")
+        endif()
+        file(APPEND "${connections}" "connection\t${type}\t${source}\t${sourceVr}\t${instance.${instanceName}}\t${vr}\n")
+    endif()
+endforeach()
+
+file(READ "${parameters}" records)
+file(APPEND "${plan}" "${records}")
+file(READ "${connections}" records)
+file(APPEND "${plan}" "${records}")
+file(REMOVE "${parameters}" "${connections}")
+
+if (DEFINED PACK_PLAN)
+    execute_process(COMMAND "${PACK_PLAN}" "${plan}" "${OUTPUT}" RESULT_VARIABLE result)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "${PACK_PLAN} failed to pack ${plan}")
+    endif()
+endif()
@@ -13,6 +13,8 @@
 #define NUMBER_OF_INTEGERS 0
 #define NUMBER_OF_BOOLEANS 0
 #define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_INTERNAL_STATES 2
+#define HAS_STATE_DERIVATIVE_NORM 1
 
 const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
 
@@ -138,3 +140,24 @@ fmi2Status OutputUpdate(fmi2Component component)
 	return fmi2OK;
 }
 
+
+fmi2Status StateDerivativeNorm(fmi2Component component, fmi2Real* norm)
+{
+    fmi2Real dx_PI = _r - _x_PT1;
+    fmi2Real dx_PT1 = (_K * _KI * _x_PI - (1 + _K * _KP) * _x_PT1 + _K * _KP * _r) / _T;
+    *norm = fmax(fabs(dx_PI), fabs(dx_PT1));
+    return fmi2OK;
+}
+
+void SaveInternal(fmi2Component component, fmi2Real state[])
+{
+    state[0] = _x_PI;
+    state[1] = _x_PT1;
+}
+
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[])
+{
+    _x_PI = state[0];
+    _x_PT1 = state[1];
+    return fmi2OK;
+}
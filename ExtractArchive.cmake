@@ -0,0 +1,118 @@
+# Content addressed extraction cache for FMU archives.
+#
+# An archive is extracted once into <cache>/<SHA256 of the archive>, next
+# to the extracted files modelDescription.cmake holds the parsed model
+# description:
+#   modelDescription.guid, modelDescription.modelIdentifier
+#   modelDescription.variables               list of variable names
+#   modelDescription.<name>.vr               value reference
+#   modelDescription.<name>.type             Real, Integer, Boolean or String
+#   modelDescription.<name>.causality        causality, local if not given
+#   modelDescription.<name>.variability      variability, continuous if not given
+# A cache directory is complete once it exists. It is filled under a file
+# lock in a temporary directory and renamed, so concurrent runs sharing a
+# cache extract every archive only once. modelDescription.cmake of an older
+# format is parsed again from the extracted modelDescription.xml.
+#
+# Included it provides ExtractArchive(<archive> <cache> <directory variable>),
+# as a script it prints the directory of the extracted archive:
+# cmake -D ARCHIVE=<archive.fmu> [-D CACHE_DIRECTORY=<cache>] -P ExtractArchive.cmake
+#
+# The cache defaults to the environment variable FMU_CACHE_DIRECTORY or to
+# fmus in the working directory.
+
+cmake_minimum_required(VERSION 3.5)
+
+set(MODEL_DESCRIPTION_FORMAT 3)
+
+function(ParseModelDescription modelDescription output)
+    file(READ "${modelDescription}" xml)
+    set(parsed "set(modelDescription.format ${MODEL_DESCRIPTION_FORMAT})\n")
+    string(REGEX MATCH "[ \t\r\n]guid=\"([^\"]*)\"" match "${xml}")
+    string(APPEND parsed "set(modelDescription.guid \"${CMAKE_MATCH_1}\")\n")
+    string(REGEX MATCH "<CoSimulation[^>]*modelIdentifier=\"([^\"]*)\"" match "${xml}")
+    string(APPEND parsed "set(modelDescription.modelIdentifier \"${CMAKE_MATCH_1}\")\n")
+    set(names "")
+    string(REGEX MATCHALL "<ScalarVariable[^>]*>[ \t\r\n]*<[A-Za-z]+" variables "${xml}")
+    foreach(variable ${variables})
+        string(REGEX MATCH "[ \t\r\n]name=\"([^\"]*)\"" match "${variable}")
+        set(name "${CMAKE_MATCH_1}")
+        list(APPEND names "${name}")
+        string(REGEX MATCH "valueReference=\"([0-9]+)\"" match "${variable}")
+        string(APPEND parsed "set(\"modelDescription.${name}.vr\" ${CMAKE_MATCH_1})\n")
+        string(REGEX MATCH "<([A-Za-z]+)$" match "${variable}")
+        string(APPEND parsed "set(\"modelDescription.${name}.type\" ${CMAKE_MATCH_1})\n")
+        set(causality local)
+        if (variable MATCHES "[ \t\r\n]causality=\"([a-zA-Z]+)\"")
+            set(causality "${CMAKE_MATCH_1}")
+        endif()
+        string(APPEND parsed "set(\"modelDescription.${name}.causality\" ${causality})\n")
+        set(variability continuous)
+        if (variable MATCHES "[ \t\r\n]variability=\"([a-zA-Z]+)\"")
+            set(variability "${CMAKE_MATCH_1}")
+        endif()
+        string(APPEND parsed "set(\"modelDescription.${name}.variability\" ${variability})\n")
+    endforeach()
+    string(APPEND parsed "set(modelDescription.variables \"${names}\")\n")
+    file(WRITE "${output}" "${parsed}")
+endfunction()
+
+function(IsExtracted extracted result)
+    set(${result} FALSE PARENT_SCOPE)
+    if (EXISTS "${extracted}/modelDescription.cmake")
+        include("${extracted}/modelDescription.cmake")
+        if ("${modelDescription.format}" STREQUAL "${MODEL_DESCRIPTION_FORMAT}")
+            set(${result} TRUE PARENT_SCOPE)
+        endif()
+    endif()
+endfunction()
+
+function(ExtractArchive archive cache directory)
+    get_filename_component(archive "${archive}" ABSOLUTE)
+    file(SHA256 "${archive}" hash)
+    set(extracted "${cache}/${hash}")
+    IsExtracted("${extracted}" current)
+    if (NOT current)
+        file(MAKE_DIRECTORY "${cache}")
+        file(LOCK "${extracted}.lock" GUARD FUNCTION TIMEOUT 600 RESULT_VARIABLE result)
+        if (NOT result EQUAL 0)
+            message(FATAL_ERROR "${extracted}.lock could not be locked: ${result}")
+        endif()
+        # Another process could have extracted it while we waited
+        IsExtracted("${extracted}" current)
+        if (NOT current AND EXISTS "${extracted}/modelDescription.xml")
+            ParseModelDescription("${extracted}/modelDescription.xml" "${extracted}/modelDescription.cmake.partial")
+            file(RENAME "${extracted}/modelDescription.cmake.partial" "${extracted}/modelDescription.cmake")
+        elseif (NOT current)
+            set(partial "${extracted}.partial")
+            file(REMOVE_RECURSE "${partial}")
+            file(MAKE_DIRECTORY "${partial}")
+            execute_process(COMMAND ${CMAKE_COMMAND} -E tar xf "${archive}"
+                WORKING_DIRECTORY "${partial}" RESULT_VARIABLE result)
+            if (NOT result EQUAL 0 OR NOT EXISTS "${partial}/modelDescription.xml")
+                file(REMOVE_RECURSE "${partial}")
+                message(FATAL_ERROR "${archive} could not be extracted")
+            endif()
+            ParseModelDescription("${partial}/modelDescription.xml" "${partial}/modelDescription.cmake")
+            file(RENAME "${partial}" "${extracted}")
+        endif()
+        file(LOCK "${extracted}.lock" RELEASE)
+    endif()
+    set(${directory} "${extracted}" PARENT_SCOPE)
+endfunction()
+
+if (CMAKE_SCRIPT_MODE_FILE STREQUAL CMAKE_CURRENT_LIST_FILE)
+    if (NOT DEFINED ARCHIVE)
+        message(FATAL_ERROR "ARCHIVE is not set")
+    endif()
+    if (NOT DEFINED CACHE_DIRECTORY)
+        if (DEFINED ENV{FMU_CACHE_DIRECTORY})
+            set(CACHE_DIRECTORY "$ENV{FMU_CACHE_DIRECTORY}")
+        else()
+            set(CACHE_DIRECTORY fmus)
+        endif()
+    endif()
+    get_filename_component(CACHE_DIRECTORY "${CACHE_DIRECTORY}" ABSOLUTE)
+    ExtractArchive("${ARCHIVE}" "${CACHE_DIRECTORY}" directory)
+    execute_process(COMMAND ${CMAKE_COMMAND} -E echo "${directory}")
+endif()
@@ -8,12 +8,15 @@
  */
 #include <fmi2Functions.h>
 #include <math.h>
+#include <blocks.h>
 
 #define MAX_INPUT_DERIVATIVE_ORDER 10
+#define MAX_OUTPUT_DERIVATIVE_ORDER MAX_INPUT_DERIVATIVE_ORDER
 #define NUMBER_OF_REALS 3
 #define NUMBER_OF_INTEGERS 0
 #define NUMBER_OF_BOOLEANS 0
 #define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_INTERNAL_STATES 0
 
 const fmi2ValueReference ivrs[] = {0, 1, 2};
 
@@ -41,13 +44,12 @@ void FreeInternal(fmi2Component component)
 
 void StartInitialization(fmi2Component component)
 {
-    _u = 0.;
-    _K = 1.;
+    BlockEvaluate(component, GainStart, 0.);
 }
 
 fmi2Status FinishInitialization(fmi2Component component)
 {
-    _y = _K * _u;
+    BlockEvaluate(component, GainOutput, 0.);
     return fmi2OK;
 }
 
@@ -59,6 +61,26 @@ fmi2Status StateUpdate(fmi2Component component, fmi2Real h)
 
 fmi2Status OutputUpdate(fmi2Component component)
 {
-	_y = _K * _u;
+	BlockEvaluate(component, GainOutput, 0.);
 	return fmi2OK;
-}
\ No newline at end of file
+}
+
+fmi2Status OutputDerivative(fmi2Component component, fmi2ValueReference vr, fmi2Integer order, fmi2Real* value)
+{
+    if (vr != 1)
+    {
+        return fmi2Error;
+    }
+    /* At the time the input was set, as is y itself */
+    *value = _K * r(vr_u,order);
+    return fmi2OK;
+}
+
+void SaveInternal(fmi2Component component, fmi2Real state[])
+{
+}
+
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[])
+{
+    return fmi2OK;
+}
@@ -0,0 +1,183 @@
+# Generates a configuration of INSTANCES independent copies of one of the
+# shipped benchmarks, or a chain of INSTANCES coupled blocks, and the
+# matching reference configuration.
+#
+# cmake -D TOPOLOGY=<topology> -D INSTANCES=<count> [-D SEED=<seed>] [-D RANDOMIZE=ON]
+#       [-D OUTPUT=<name>] -P GenerateConfiguration.cmake
+#
+# TOPOLOGY is one of
+#   TwoMassOscillatorD2D - OscillatorD2D pairs, reference TwoMassOscillator
+#   TwoMassOscillatorF2D - OscillatorD2F/OscillatorF2D pairs, reference TwoMassOscillator
+#   Control              - PI/PT1 loops, reference ControlLoopPIxPT1
+#   StepSubtraction      - Step/Gain/Subtraction groups, reference Zero
+#   GainChain            - one Step through a chain of INSTANCES unit gains,
+#                          subtracted from the Step at its end, reference Zero
+#
+# With RANDOMIZE the parameters of every copy are drawn from SEED,
+# otherwise the values of the shipped configurations are used.
+# OUTPUT.xml and OUTPUTReference.xml are written, OUTPUT defaults to
+# <TOPOLOGY><INSTANCES>.
+
+cmake_minimum_required(VERSION 3.5)
+
+if (NOT DEFINED TOPOLOGY)
+    message(FATAL_ERROR "TOPOLOGY is not set")
+endif()
+if (NOT DEFINED INSTANCES)
+    set(INSTANCES 1)
+endif()
+if (NOT INSTANCES MATCHES "^[0-9]+$" OR INSTANCES LESS 1)
+    message(FATAL_ERROR "INSTANCES = ${INSTANCES} has to be a positive integer")
+endif()
+if (NOT DEFINED SEED)
+    set(SEED 0)
+endif()
+if (NOT DEFINED OUTPUT)
+    set(OUTPUT "${TOPOLOGY}${INSTANCES}")
+endif()
+
+set(HEADER "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<Configuration xmlns:xsd=\"http://www.w3.org/2001/XMLSchema\" xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">\n")
+set(FOOTER "</Configuration>\n")
+
+set(RANDOM_SEEDED OFF)
+
+# Sets var to a decimal with the integer digit taken from alphabet and two
+# random decimals, or to value when the parameters are not randomized.
+function(Value var value alphabet)
+    if (RANDOMIZE)
+        if (NOT RANDOM_SEEDED)
+            string(RANDOM LENGTH 1 RANDOM_SEED ${SEED} dummy)
+            set(RANDOM_SEEDED ON PARENT_SCOPE)
+        endif()
+        string(RANDOM LENGTH 1 ALPHABET ${alphabet} integer)
+        string(RANDOM LENGTH 2 ALPHABET 0123456789 decimals)
+        set(${var} "${integer}.${decimals}" PARENT_SCOPE)
+    else()
+        set(${var} "${value}" PARENT_SCOPE)
+    endif()
+endfunction()
+
+function(Instance path instanceName archiveName)
+    set(xml "        <Instance instanceName=\"${instanceName}\">\n")
+    string(APPEND xml "            <Archive archiveName=\"${archiveName}.fmu\"/>\n")
+    if (ARGN)
+        string(APPEND xml "            <Parameters>\n")
+        set(parameters ${ARGN})
+        while (parameters)
+            list(GET parameters 0 name)
+            list(GET parameters 1 value)
+            list(REMOVE_AT parameters 0 1)
+            string(APPEND xml "                <Parameter name=\"${name}\" value=\"${value}\"/>\n")
+        endwhile()
+        string(APPEND xml "            </Parameters>\n")
+    endif()
+    string(APPEND xml "        </Instance>\n")
+    file(APPEND "${path}" "${xml}")
+endfunction()
+
+function(Connection path source output destination input)
+    set(xml "        <Connection>\n")
+    string(APPEND xml "            <Source instanceName=\"${source}\" outputName=\"${output}\"/>\n")
+    string(APPEND xml "            <Destination instanceName=\"${destination}\" inputName=\"${input}\"/>\n")
+    string(APPEND xml "        </Connection>\n")
+    file(APPEND "${path}" "${xml}")
+endfunction()
+
+# The connections are collected in a temporary file until all instances are written
+set(instances "${OUTPUT}.xml")
+set(connections "${OUTPUT}.connections")
+set(references "${OUTPUT}Reference.xml")
+file(WRITE "${instances}" "${HEADER}    <Instances>\n")
+file(WRITE "${connections}" "")
+file(WRITE "${references}" "${HEADER}    <Instances>\n")
+
+if (TOPOLOGY STREQUAL "GainChain")
+    # Every gain has to stay 1 for the difference to be zero
+    Value(y0 "0." 0123)
+    Value(yEnd "1." 0123)
+    Value(tStep "1." 0123)
+    Instance("${instances}" Step Step y0 ${y0} yEnd ${yEnd} tStep ${tStep})
+    set(previous Step)
+endif()
+
+foreach(k RANGE 1 ${INSTANCES})
+    if (TOPOLOGY STREQUAL "TwoMassOscillatorD2D" OR TOPOLOGY STREQUAL "TwoMassOscillatorF2D")
+        Value(m1 "10." 123456789)
+        Value(c1 "1." 123)
+        Value(d1 "1." 123)
+        Value(ck "1." 123)
+        Value(dk "2." 123)
+        Value(m2 "10." 123456789)
+        Value(c2 "1." 123)
+        Value(d2 "2." 123)
+        Value(x01 "0.1" 0)
+        Value(v01 "0.1" 0)
+        Value(x02 "0.2" 0)
+        Value(v02 "0.1" 0)
+        if (TOPOLOGY STREQUAL "TwoMassOscillatorD2D")
+            set(first "Oscillator1_${k}")
+            set(second "Oscillator2_${k}")
+            Instance("${instances}" ${first} OscillatorD2D
+                m ${m1} c ${c1} d ${d1} ck ${ck} dk ${dk} x0 ${x01} v0 ${v01})
+            Instance("${instances}" ${second} OscillatorD2D
+                m ${m2} c ${c2} d ${d2} ck ${ck} dk ${dk} x0 ${x02} v0 ${v02})
+            Connection("${connections}" ${first} xThis ${second} xOther)
+            Connection("${connections}" ${first} vThis ${second} vOther)
+        else()
+            set(first "OscillatorD2F_${k}")
+            set(second "OscillatorF2D_${k}")
+            Instance("${instances}" ${first} OscillatorD2F
+                m ${m1} c ${c1} d ${d1} ck ${ck} dk ${dk} x0 ${x01} v0 ${v01})
+            Instance("${instances}" ${second} OscillatorF2D
+                m ${m2} c ${c2} d ${d2} x0 ${x02} v0 ${v02})
+            Connection("${connections}" ${first} FThis ${second} FOther)
+        endif()
+        Connection("${connections}" ${second} xThis ${first} xOther)
+        Connection("${connections}" ${second} vThis ${first} vOther)
+        Instance("${references}" "TwoMassOscillator_${k}" TwoMassOscillator
+            m_1 ${m1} c_1 ${c1} d_1 ${d1} ck ${ck} dk ${dk} x0_1 ${x01} v0_1 ${v01}
+            m_2 ${m2} c_2 ${c2} d_2 ${d2} x0_2 ${x02} v0_2 ${v02})
+    elseif (TOPOLOGY STREQUAL "Control")
+        Value(KP "10." 0123456789)
+        Value(KI "10." 123456789)
+        Value(K "1." 123)
+        Value(T "1." 123)
+        Value(r "1." 0123)
+        Instance("${instances}" "PT1_${k}" PT1 K ${K} T ${T} x0 "0.")
+        Instance("${instances}" "PI_${k}" PI KP ${KP} KI ${KI} x0 "0." r ${r})
+        Connection("${connections}" "PT1_${k}" y "PI_${k}" u)
+        Connection("${connections}" "PI_${k}" y "PT1_${k}" u)
+        Instance("${references}" "ControlLoop_${k}" ControlLoopPIxPT1
+            KP ${KP} KI ${KI} K ${K} T ${T} r ${r} x0_PI "0." x0_PT1 "0.")
+    elseif (TOPOLOGY STREQUAL "StepSubtraction")
+        # The gain has to stay 1 for the difference to be zero
+        Value(y0 "0." 0123)
+        Value(yEnd "1." 0123)
+        Value(tStep "1." 0123)
+        Instance("${instances}" "Step_${k}" Step y0 ${y0} yEnd ${yEnd} tStep ${tStep})
+        Instance("${instances}" "Gain_${k}" Gain K "1.")
+        Instance("${instances}" "Subtraction_${k}" Subtraction)
+        Connection("${connections}" "Step_${k}" y "Gain_${k}" u)
+        Connection("${connections}" "Gain_${k}" y "Subtraction_${k}" u1)
+        Connection("${connections}" "Step_${k}" y "Subtraction_${k}" u2)
+        Instance("${references}" "Zero_${k}" Zero)
+    elseif (TOPOLOGY STREQUAL "GainChain")
+        Instance("${instances}" "Gain_${k}" Gain K "1.")
+        Connection("${connections}" ${previous} y "Gain_${k}" u)
+        set(previous "Gain_${k}")
+    else()
+        message(FATAL_ERROR "Unknown TOPOLOGY = ${TOPOLOGY}")
+    endif()
+endforeach()
+
+if (TOPOLOGY STREQUAL "GainChain")
+    Instance("${instances}" Subtraction Subtraction)
+    Connection("${connections}" ${previous} y Subtraction u1)
+    Connection("${connections}" Step y Subtraction u2)
+    Instance("${references}" Zero Zero)
+endif()
+
+file(READ "${connections}" xml)
+file(REMOVE "${connections}")
+file(APPEND "${instances}" "    </Instances>\n    <Connections>\n${xml}    </Connections>\n${FOOTER}")
+file(APPEND "${references}" "    </Instances>\n${FOOTER}")
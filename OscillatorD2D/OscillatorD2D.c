@@ -4,6 +4,10 @@
  * Copyright (c) 2017 Slaven Glumac
  *
  * Single mass displacement-to-displacement oscillator.
+ *
+ * With sensitivities set the variational equations are integrated along
+ * with the states and dxThis_dp, dvThis_dp give the derivatives of the
+ * outputs by the parameters p = m, c, d, ck and dk for the given inputs.
  */
 #include <fmi2Functions.h>
 #include <cvode/cvode.h>
@@ -13,12 +17,17 @@
 #include <sundials/sundials_types.h>
 
 #define MAX_INPUT_DERIVATIVE_ORDER 10
-#define NUMBER_OF_REALS 9
+#define MAX_OUTPUT_DERIVATIVE_ORDER 5
+#define NUMBER_OF_REALS 19
 #define NUMBER_OF_INTEGERS 0
-#define NUMBER_OF_BOOLEANS 0
+#define NUMBER_OF_BOOLEANS 1
 #define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_INTERNAL_STATES ((size_t)NV_LENGTH_S(_y))
+#define HAS_INTEGRATOR_STATISTICS 1
+#define HAS_STATE_DERIVATIVE_NORM 1
 
-const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 2, 3};
+const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 2, 3,
+    9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 0};
 
 #define vr_xOther 0
 #define vr_vOther 1
@@ -33,20 +42,41 @@ const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 2, 3};
 #define _dk r(8,0)
 #define _x0 r(9,0)
 #define _v0 r(10,0)
+#define vr_dxThis 11
+#define vr_dvThis 16
+#define _dxThis(p) r(vr_dxThis + (p),0)
+#define _dvThis(p) r(vr_dvThis + (p),0)
+#define _sensitivities b(21)
 
 #define NUMBER_OF_STATES 2
+#define NUMBER_OF_PARAMETERS 5
+/* States followed by their derivatives by m, c, d, ck and dk */
+#define NUMBER_OF_AUGMENTED_STATES (NUMBER_OF_STATES * (1 + NUMBER_OF_PARAMETERS))
+
+#define NVECTOR_FIXED_LENGTH NUMBER_OF_STATES
+#include <nvector_fixed.h>
 #define _xS NV_Ith_S(y,0)
 #define _vS NV_Ith_S(y,1)
 #define _dxS NV_Ith_S(dy,0)
 #define _dvS NV_Ith_S(dy,1)
+#define _sxS(p) NV_Ith_S(y,NUMBER_OF_STATES * (1 + (p)))
+#define _svS(p) NV_Ith_S(y,NUMBER_OF_STATES * (1 + (p)) + 1)
+#define _dsxS(p) NV_Ith_S(dy,NUMBER_OF_STATES * (1 + (p)))
+#define _dsvS(p) NV_Ith_S(dy,NUMBER_OF_STATES * (1 + (p)) + 1)
 #define Jac(i,j) DENSE_ELEM(J,i,j)
 
 #define _y _internal.y
 #define _cvode _internal.cvode
+#define _dky _internal.dky
 struct Internal
 {
     N_Vector y;
     void* cvode;
+    N_Vector dky;
+    struct FixedVector yStorage;
+    struct FixedVector dkyStorage;
+    realtype augmented[NUMBER_OF_AUGMENTED_STATES];
+    realtype dkyAugmented[NUMBER_OF_AUGMENTED_STATES];
 };
 
 #include <template.h>
@@ -63,6 +93,23 @@ static int f(realtype t, N_Vector y, N_Vector dy, void *user_data)
     _dvS += _ck / _m * xOther;
     _dvS += _dk / _m * vOther;
 
+    if (NV_LENGTH_S(y) > NUMBER_OF_STATES)
+    {
+        /* The inputs are given, so they do not depend on the parameters */
+        realtype dfdp[NUMBER_OF_PARAMETERS];
+        int p;
+        dfdp[0] = -_dvS / _m;
+        dfdp[1] = -_xS / _m;
+        dfdp[2] = -_vS / _m;
+        dfdp[3] = (xOther - _xS) / _m;
+        dfdp[4] = (vOther - _vS) / _m;
+        for (p = 0; p < NUMBER_OF_PARAMETERS; p++)
+        {
+            _dsxS(p) = _svS(p);
+            _dsvS(p) = -(_c + _ck) / _m * _sxS(p) - (_d + _dk) / _m * _svS(p) + dfdp[p];
+        }
+    }
+
     return CV_SUCCESS;
 }
 
@@ -74,6 +121,22 @@ static int Jacobian(long int N, realtype t, N_Vector y, N_Vector fy, DlsMat J, v
     Jac(0,1) = 1.;
     Jac(1,0) = -(_c + _ck) / _m;
     Jac(1,1) = -(_d + _dk) / _m;
+    if (_sensitivities)
+    {
+        /* Derivatives of df/dp by x and v */
+        const realtype dx[NUMBER_OF_PARAMETERS] = {(_c + _ck) / (_m * _m), -1. / _m, 0., -1. / _m, 0.};
+        const realtype dv[NUMBER_OF_PARAMETERS] = {(_d + _dk) / (_m * _m), 0., -1. / _m, 0., -1. / _m};
+        int p;
+        for (p = 0; p < NUMBER_OF_PARAMETERS; p++)
+        {
+            int k = NUMBER_OF_STATES * (1 + p);
+            Jac(k,k + 1) = 1.;
+            Jac(k + 1,0) = dx[p];
+            Jac(k + 1,1) = dv[p];
+            Jac(k + 1,k) = -(_c + _ck) / _m;
+            Jac(k + 1,k + 1) = -(_d + _dk) / _m;
+        }
+    }
 
     return CV_SUCCESS;
 }
@@ -81,19 +144,29 @@ static int Jacobian(long int N, realtype t, N_Vector y, N_Vector fy, DlsMat J, v
 void InstantiateInternal(fmi2Component component)
 {
     _cvode = CVodeCreate(CV_BDF, CV_NEWTON);
-    _y = N_VNew_Serial(NUMBER_OF_STATES);
+    _y = N_VMake_Fixed(&_internal.yStorage);
+    _dky = N_VMake_Fixed(&_internal.dkyStorage);
 }
 
 void FreeInternal(fmi2Component component)
 {
-    N_VDestroy_Serial(_y);
     CVodeFree(&_cvode);
+    if (_y != &_internal.yStorage.vector)
+    {
+        N_VDestroy_Serial(_y);
+        N_VDestroy_Serial(_dky);
+    }
 }
 
 fmi2Status InitializeIntegrator(fmi2Component component)
 {
     realtype reltol = 1e-8;
     realtype abstol = 1e-8;
+    if (_toleranceDefined)
+    {
+        reltol = _tolerance;
+        abstol = _tolerance;
+    }
     log(fmi2OK, "Hello from InitializeIntegrator!");
     if (CVodeInit(_cvode, f, _t, _y) != CV_SUCCESS)
     {
@@ -107,7 +180,7 @@ fmi2Status InitializeIntegrator(fmi2Component component)
     {
       return fmi2Error;
     }
-    if (CVDense(_cvode, NUMBER_OF_STATES) != CV_SUCCESS)
+    if (CVDense(_cvode, NV_LENGTH_S(_y)) != CV_SUCCESS)
     {
         return fmi2Error;
     }
@@ -134,6 +207,33 @@ void StartInitialization(fmi2Component component)
 fmi2Status FinishInitialization(fmi2Component component)
 {
     N_Vector y = _y;
+    if (_sensitivities)
+    {
+        int p;
+        N_Vector dky = N_VMake_Serial(NUMBER_OF_AUGMENTED_STATES, _internal.dkyAugmented);
+        y = N_VMake_Serial(NUMBER_OF_AUGMENTED_STATES, _internal.augmented);
+        if (y == NULL || dky == NULL)
+        {
+            if (y != NULL)
+            {
+                N_VDestroy_Serial(y);
+            }
+            if (dky != NULL)
+            {
+                N_VDestroy_Serial(dky);
+            }
+            return fmi2Error;
+        }
+        _y = y;
+        _dky = dky;
+        for (p = 0; p < NUMBER_OF_PARAMETERS; p++)
+        {
+            _sxS(p) = 0.;
+            _svS(p) = 0.;
+            _dxThis(p) = 0.;
+            _dvThis(p) = 0.;
+        }
+    }
     _xS = _x0;
     _vS = _v0;
     return InitializeIntegrator(component);
@@ -143,12 +243,25 @@ fmi2Status StateUpdate(fmi2Component component, fmi2Real h)
 {
     N_Vector y = _y;
     realtype tReached;
-    if (CVode(_cvode, _t + h, _y, &tReached, CV_NORMAL) != CV_SUCCESS)
+    if (CVodeSetStopTime(_cvode, _t + h) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVode(_cvode, _t + h, _y, &tReached, CV_NORMAL) < 0)
     {
         return fmi2Error;
     }
     _xThis = _xS;
     _vThis = _vS;
+    if (_sensitivities)
+    {
+        int p;
+        for (p = 0; p < NUMBER_OF_PARAMETERS; p++)
+        {
+            _dxThis(p) = _sxS(p);
+            _dvThis(p) = _svS(p);
+        }
+    }
     return fmi2OK;
 }
 
@@ -156,3 +269,115 @@ fmi2Status OutputUpdate(fmi2Component component)
 {
 	return fmi2OK;
 }
+
+fmi2Status OutputDerivative(fmi2Component component, fmi2ValueReference vr, fmi2Integer order, fmi2Real* value)
+{
+    N_Vector y = _dky;
+    realtype hLast;
+    int qLast;
+    if (CVodeGetLastStep(_cvode, &hLast) != CV_SUCCESS || hLast == 0.)
+    {
+        log(fmi2Error, "Output derivatives are available after the first step!");
+        return fmi2Error;
+    }
+    if (CVodeGetLastOrder(_cvode, &qLast) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (order > qLast)
+    {
+        *value = 0.;
+        return fmi2OK;
+    }
+    if (CVodeGetDky(_cvode, _t, order, _dky) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    switch (vr)
+    {
+    case 2:
+        *value = _xS;
+        break;
+    case 3:
+        *value = _vS;
+        break;
+    default:
+        if (vr < vr_dxThis || vr >= vr_dvThis + NUMBER_OF_PARAMETERS)
+        {
+            return fmi2Error;
+        }
+        if (!_sensitivities)
+        {
+            *value = 0.;
+        }
+        else if (vr < vr_dvThis)
+        {
+            *value = _sxS(vr - vr_dxThis);
+        }
+        else
+        {
+            *value = _svS(vr - vr_dvThis);
+        }
+        break;
+    }
+    return fmi2OK;
+}
+
+fmi2Status IntegratorStatistics(fmi2Component component, struct IntegratorStatistics* statistics)
+{
+    long int linearSolverSetups;
+    int qLast, qCurrent;
+    realtype hInitial, hLast, hCurrent, tCurrent;
+    if (CVodeGetIntegratorStats(_cvode, &statistics->steps, &statistics->rhsEvaluations,
+        &linearSolverSetups, &statistics->errorTestFailures, &qLast, &qCurrent,
+        &hInitial, &hLast, &hCurrent, &tCurrent) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVDlsGetNumJacEvals(_cvode, &statistics->jacobianEvaluations) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVodeGetNumNonlinSolvIters(_cvode, &statistics->newtonIterations) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
+
+fmi2Status StateDerivativeNorm(fmi2Component component, fmi2Real* norm)
+{
+    N_Vector dy = _dky;
+    if (f(_t, _y, dy, component) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    /* Without the sensitivities */
+    *norm = fmax(fabs(_dxS), fabs(_dvS));
+    return fmi2OK;
+}
+
+void SaveInternal(fmi2Component component, fmi2Real state[])
+{
+    N_Vector y = _y;
+    size_t i;
+    for (i = 0; i < NUMBER_OF_INTERNAL_STATES; i++)
+    {
+        state[i] = NV_Ith_S(y, i);
+    }
+}
+
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[])
+{
+    N_Vector y = _y;
+    size_t i;
+    for (i = 0; i < NUMBER_OF_INTERNAL_STATES; i++)
+    {
+        NV_Ith_S(y, i) = state[i];
+    }
+    if (CVodeReInit(_cvode, _t, _y) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
@@ -13,10 +13,14 @@
 #include <sundials/sundials_types.h>
 
 #define MAX_INPUT_DERIVATIVE_ORDER 10
+#define MAX_OUTPUT_DERIVATIVE_ORDER 5
 #define NUMBER_OF_REALS 6
 #define NUMBER_OF_INTEGERS 0
 #define NUMBER_OF_BOOLEANS 0
 #define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_INTERNAL_STATES NUMBER_OF_STATES
+#define HAS_INTEGRATOR_STATISTICS 1
+#define HAS_STATE_DERIVATIVE_NORM 1
 
 const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4, 5, 1, 2};
 
@@ -31,6 +35,9 @@ const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4, 5, 1, 2};
 #define _v0 r(7,0)
 
 #define NUMBER_OF_STATES 2
+
+#define NVECTOR_FIXED_LENGTH NUMBER_OF_STATES
+#include <nvector_fixed.h>
 #define _xS NV_Ith_S(y,0)
 #define _vS NV_Ith_S(y,1)
 #define _dxS NV_Ith_S(dy,0)
@@ -39,10 +46,14 @@ const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4, 5, 1, 2};
 
 #define _y _internal.y
 #define _cvode _internal.cvode
+#define _dky _internal.dky
 struct Internal
 {
     N_Vector y;
     void* cvode;
+    N_Vector dky;
+    struct FixedVector yStorage;
+    struct FixedVector dkyStorage;
 };
 
 #include <template.h>
@@ -73,12 +84,12 @@ static int Jacobian(long int N, realtype t, N_Vector y, N_Vector fy, DlsMat J, v
 void InstantiateInternal(fmi2Component component)
 {
     _cvode = CVodeCreate(CV_BDF, CV_NEWTON);
-    _y = N_VNew_Serial(NUMBER_OF_STATES);
+    _y = N_VMake_Fixed(&_internal.yStorage);
+    _dky = N_VMake_Fixed(&_internal.dkyStorage);
 }
 
 void FreeInternal(fmi2Component component)
 {
-    N_VDestroy_Serial(_y);
     CVodeFree(&_cvode);
 }
 
@@ -86,6 +97,11 @@ fmi2Status InitializeIntegrator(fmi2Component component)
 {
     realtype reltol = 0.;
     realtype abstol = 1e-8;
+    if (_toleranceDefined)
+    {
+        reltol = _tolerance;
+        abstol = _tolerance;
+    }
     log(fmi2OK, "Hello from InitializeIntegrator!");
     if (CVodeInit(_cvode, f, _t, _y) != CV_SUCCESS)
     {
@@ -132,7 +148,11 @@ fmi2Status StateUpdate(fmi2Component component, fmi2Real h)
 {
     N_Vector y = _y;
     realtype tReached;
-    if (CVode(_cvode, _t + h, _y, &tReached, CV_NORMAL) != CV_SUCCESS)
+    if (CVodeSetStopTime(_cvode, _t + h) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVode(_cvode, _t + h, _y, &tReached, CV_NORMAL) < 0)
     {
         return fmi2Error;
     }
@@ -145,3 +165,99 @@ fmi2Status OutputUpdate(fmi2Component component)
 {
 	return fmi2OK;
 }
+
+fmi2Status OutputDerivative(fmi2Component component, fmi2ValueReference vr, fmi2Integer order, fmi2Real* value)
+{
+    N_Vector y = _dky;
+    realtype hLast;
+    int qLast;
+    if (CVodeGetLastStep(_cvode, &hLast) != CV_SUCCESS || hLast == 0.)
+    {
+        log(fmi2Error, "Output derivatives are available after the first step!");
+        return fmi2Error;
+    }
+    if (CVodeGetLastOrder(_cvode, &qLast) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (order > qLast)
+    {
+        *value = 0.;
+        return fmi2OK;
+    }
+    if (CVodeGetDky(_cvode, _t, order, _dky) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    switch (vr)
+    {
+    case 1:
+        *value = _xS;
+        break;
+    case 2:
+        *value = _vS;
+        break;
+    default:
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
+
+fmi2Status IntegratorStatistics(fmi2Component component, struct IntegratorStatistics* statistics)
+{
+    long int linearSolverSetups;
+    int qLast, qCurrent;
+    realtype hInitial, hLast, hCurrent, tCurrent;
+    if (CVodeGetIntegratorStats(_cvode, &statistics->steps, &statistics->rhsEvaluations,
+        &linearSolverSetups, &statistics->errorTestFailures, &qLast, &qCurrent,
+        &hInitial, &hLast, &hCurrent, &tCurrent) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVDlsGetNumJacEvals(_cvode, &statistics->jacobianEvaluations) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVodeGetNumNonlinSolvIters(_cvode, &statistics->newtonIterations) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
+
+fmi2Status StateDerivativeNorm(fmi2Component component, fmi2Real* norm)
+{
+    struct FixedVector derivatives;
+    N_Vector dy = N_VMake_Fixed(&derivatives);
+    if (f(_t, _y, dy, component) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    *norm = N_VMaxNorm_Fixed(dy);
+    return fmi2OK;
+}
+
+void SaveInternal(fmi2Component component, fmi2Real state[])
+{
+    N_Vector y = _y;
+    size_t i;
+    for (i = 0; i < NUMBER_OF_STATES; i++)
+    {
+        state[i] = NV_Ith_S(y, i);
+    }
+}
+
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[])
+{
+    N_Vector y = _y;
+    size_t i;
+    for (i = 0; i < NUMBER_OF_STATES; i++)
+    {
+        NV_Ith_S(y, i) = state[i];
+    }
+    if (CVodeReInit(_cvode, _t, _y) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
@@ -10,6 +10,9 @@
 #define NUMBER_OF_INTEGERS 0
 #define NUMBER_OF_BOOLEANS 0
 #define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_INTERNAL_STATES NUMBER_OF_STATES
+#define HAS_INTEGRATOR_STATISTICS 1
+#define HAS_STATE_DERIVATIVE_NORM 1
 
 const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 7, 8};
 
@@ -29,6 +32,9 @@ const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 7, 8};
 #define _phiOther r(9,0)
 
 #define NUMBER_OF_STATES 3
+
+#define NVECTOR_FIXED_LENGTH NUMBER_OF_STATES
+#include <nvector_fixed.h>
 #define _phiThisS NV_Ith_S(y,0)
 #define _omegaThisS NV_Ith_S(y,1)
 #define _phiOtherS NV_Ith_S(y,2)
@@ -43,6 +49,7 @@ struct Internal
 {
     N_Vector y;
     void* cvode;
+    struct FixedVector yStorage;
 };
 
 #include <template.h>
@@ -84,12 +91,11 @@ static int Jacobian(long int N, realtype t, N_Vector y, N_Vector fy, DlsMat J, v
 void InstantiateInternal(fmi2Component component)
 {
     _cvode = CVodeCreate(CV_BDF, CV_NEWTON);
-    _y = N_VNew_Serial(NUMBER_OF_STATES);
+    _y = N_VMake_Fixed(&_internal.yStorage);
 }
 
 void FreeInternal(fmi2Component component)
 {
-    N_VDestroy_Serial(_y);
     CVodeFree(&_cvode);
 }
 
@@ -97,6 +103,11 @@ fmi2Status InitializeIntegrator(fmi2Component component)
 {
     realtype reltol = 0.;
     realtype abstol = 1e-8;
+    if (_toleranceDefined)
+    {
+        reltol = _tolerance;
+        abstol = _tolerance;
+    }
     log(fmi2OK, "Hello from InitializeIntegrator!");
     if (CVodeInit(_cvode, f, _t, _y) != CV_SUCCESS)
     {
@@ -149,7 +160,11 @@ fmi2Status StateUpdate(fmi2Component component, fmi2Real h)
 {
     N_Vector y = _y;
     realtype tReached;
-    if (CVode(_cvode, _t + h, _y, &tReached, CV_NORMAL) != CV_SUCCESS)
+    if (CVodeSetStopTime(_cvode, _t + h) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVode(_cvode, _t + h, _y, &tReached, CV_NORMAL) < 0)
     {
 		log(fmi2Error, "The integration failed!");
         return fmi2Error;
@@ -165,3 +180,62 @@ fmi2Status OutputUpdate(fmi2Component component)
 	_tauThis = _ck * _phiThis + _dk * _omegaThis - _ck * _phiOther - _dk * _omegaOther;
 	return fmi2OK;
 }
+
+fmi2Status IntegratorStatistics(fmi2Component component, struct IntegratorStatistics* statistics)
+{
+    long int linearSolverSetups;
+    int qLast, qCurrent;
+    realtype hInitial, hLast, hCurrent, tCurrent;
+    if (CVodeGetIntegratorStats(_cvode, &statistics->steps, &statistics->rhsEvaluations,
+        &linearSolverSetups, &statistics->errorTestFailures, &qLast, &qCurrent,
+        &hInitial, &hLast, &hCurrent, &tCurrent) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVDlsGetNumJacEvals(_cvode, &statistics->jacobianEvaluations) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    if (CVodeGetNumNonlinSolvIters(_cvode, &statistics->newtonIterations) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
+
+fmi2Status StateDerivativeNorm(fmi2Component component, fmi2Real* norm)
+{
+    struct FixedVector derivatives;
+    N_Vector dy = N_VMake_Fixed(&derivatives);
+    if (f(_t, _y, dy, component) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    *norm = N_VMaxNorm_Fixed(dy);
+    return fmi2OK;
+}
+
+void SaveInternal(fmi2Component component, fmi2Real state[])
+{
+    N_Vector y = _y;
+    size_t i;
+    for (i = 0; i < NUMBER_OF_STATES; i++)
+    {
+        state[i] = NV_Ith_S(y, i);
+    }
+}
+
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[])
+{
+    N_Vector y = _y;
+    size_t i;
+    for (i = 0; i < NUMBER_OF_STATES; i++)
+    {
+        NV_Ith_S(y, i) = state[i];
+    }
+    if (CVodeReInit(_cvode, _t, _y) != CV_SUCCESS)
+    {
+        return fmi2Error;
+    }
+    return fmi2OK;
+}
@@ -3,7 +3,7 @@
  * 
  * Copyright (c) 2017 Slaven Glumac
  * 
- * The code for PI controller with reference given as a fixed parameter r:
+ * The code for PI controller with reference given as a tunable parameter r:
  * e(t) = r - u(t)
  * x'(t) = e(t)
  * y(t) = KP * e(t) + KI * x(t)
@@ -16,6 +16,8 @@
 #define NUMBER_OF_INTEGERS 0
 #define NUMBER_OF_BOOLEANS 0
 #define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_INTERNAL_STATES 1
+#define HAS_STATE_DERIVATIVE_NORM 1
 
 const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4, 5};
 
@@ -83,3 +85,20 @@ fmi2Status OutputUpdate(fmi2Component component)
 	return fmi2OK;
 }
 
+
+fmi2Status StateDerivativeNorm(fmi2Component component, fmi2Real* norm)
+{
+    *norm = fabs(_r - _u(0));
+    return fmi2OK;
+}
+
+void SaveInternal(fmi2Component component, fmi2Real state[])
+{
+    state[0] = _x;
+}
+
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[])
+{
+    _x = state[0];
+    return fmi2OK;
+}
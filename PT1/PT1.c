@@ -10,10 +10,13 @@
 #include <math.h>
 
 #define MAX_INPUT_DERIVATIVE_ORDER 10
+#define MAX_OUTPUT_DERIVATIVE_ORDER MAX_INPUT_DERIVATIVE_ORDER
 #define NUMBER_OF_REALS 5
 #define NUMBER_OF_INTEGERS 0
 #define NUMBER_OF_BOOLEANS 0
 #define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_INTERNAL_STATES 1
+#define HAS_STATE_DERIVATIVE_NORM 1
 
 const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4};
 
@@ -87,3 +90,37 @@ fmi2Status OutputUpdate(fmi2Component component)
 {
 	return fmi2OK;
 }
+
+fmi2Status OutputDerivative(fmi2Component component, fmi2ValueReference vr, fmi2Integer order, fmi2Real* value)
+{
+    fmi2Real derivative = _x;
+    fmi2Integer k;
+    if (vr != 1)
+    {
+        return fmi2Error;
+    }
+    /* T y^(k) = K u^(k-1) - y^(k-1) with the input derivatives as last set */
+    for (k = 1; k <= order; k++)
+    {
+        derivative = (_K * _u(k-1) - derivative) / _T;
+    }
+    *value = derivative;
+    return fmi2OK;
+}
+
+fmi2Status StateDerivativeNorm(fmi2Component component, fmi2Real* norm)
+{
+    *norm = fabs((_K * _u(0) - _x) / _T);
+    return fmi2OK;
+}
+
+void SaveInternal(fmi2Component component, fmi2Real state[])
+{
+    state[0] = _x;
+}
+
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[])
+{
+    _x = state[0];
+    return fmi2OK;
+}
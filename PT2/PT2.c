@@ -10,10 +10,13 @@
 #include <math.h>
 
 #define MAX_INPUT_DERIVATIVE_ORDER 0
+#define MAX_OUTPUT_DERIVATIVE_ORDER 2
 #define NUMBER_OF_REALS 7
 #define NUMBER_OF_INTEGERS 0
 #define NUMBER_OF_BOOLEANS 0
 #define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_INTERNAL_STATES 2
+#define HAS_STATE_DERIVATIVE_NORM 1
 
 const fmi2ValueReference ivrs[] = {0, 1, 2, 3, 4, 5, 6};
 
@@ -81,3 +84,44 @@ fmi2Status OutputUpdate(fmi2Component component)
 {
 	return fmi2OK;
 }
+
+fmi2Status OutputDerivative(fmi2Component component, fmi2ValueReference vr, fmi2Integer order, fmi2Real* value)
+{
+    fmi2Real x1 = _x1;
+    fmi2Real x2 = _x2;
+    fmi2Real u = _K * _u(0);
+    fmi2Integer k;
+    if (vr != 1)
+    {
+        return fmi2Error;
+    }
+    /* T1 x1' = Ku - x1, Ts x2' = x1 - x2 with the input held constant */
+    for (k = 1; k <= order; k++)
+    {
+        fmi2Real dx1 = (u - x1) / _T1;
+        x2 = (x1 - x2) / _Ts;
+        x1 = dx1;
+        u = 0.;
+    }
+    *value = x2;
+    return fmi2OK;
+}
+
+fmi2Status StateDerivativeNorm(fmi2Component component, fmi2Real* norm)
+{
+    *norm = fmax(fabs((_K * _u(0) - _x1) / _T1), fabs((_x1 - _x2) / _Ts));
+    return fmi2OK;
+}
+
+void SaveInternal(fmi2Component component, fmi2Real state[])
+{
+    state[0] = _x1;
+    state[1] = _x2;
+}
+
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[])
+{
+    _x1 = state[0];
+    _x2 = state[1];
+    return fmi2OK;
+}
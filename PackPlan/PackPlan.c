@@ -0,0 +1,319 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Slaven Glumac
+ *
+ * Packs the text plan written by CompileConfiguration.cmake into the binary
+ * plan described by plan.h:
+ * PackPlan <plan.txt> <plan>
+ */
+#include <plan.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_LINE 4096
+#define MAX_FIELDS 16
+
+struct Buffer
+{
+    char* data;
+    size_t size;
+    size_t capacity;
+};
+
+static void* Append(struct Buffer* buffer, const void* data, size_t size)
+{
+    void* destination;
+    if (buffer->size + size > buffer->capacity)
+    {
+        size_t capacity = buffer->capacity == 0 ? 4096 : buffer->capacity;
+        char* resized;
+        while (capacity < buffer->size + size)
+        {
+            capacity *= 2;
+        }
+        resized = realloc(buffer->data, capacity);
+        if (resized == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        buffer->data = resized;
+        buffer->capacity = capacity;
+    }
+    destination = buffer->data + buffer->size;
+    memcpy(destination, data, size);
+    buffer->size += size;
+    return destination;
+}
+
+/* Equal strings are stored once, found through an open addressing table */
+struct Strings
+{
+    struct Buffer buffer;
+    uint32_t* offsets;
+    size_t capacity;
+    size_t count;
+};
+
+static unsigned long Hash(const char* string)
+{
+    unsigned long hash = 5381;
+    while (*string)
+    {
+        hash = hash * 33 + (unsigned char)*string++;
+    }
+    return hash;
+}
+
+static uint32_t AddString(struct Strings* strings, const char* string)
+{
+    size_t k;
+    if (2 * (strings->count + 1) > strings->capacity)
+    {
+        size_t capacity = strings->capacity == 0 ? 256 : 2 * strings->capacity;
+        uint32_t* offsets = malloc(capacity * sizeof(uint32_t));
+        if (offsets == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        for (k = 0; k < capacity; k++)
+        {
+            offsets[k] = UINT32_MAX;
+        }
+        for (k = 0; k < strings->capacity; k++)
+        {
+            if (strings->offsets[k] != UINT32_MAX)
+            {
+                size_t j = Hash(strings->buffer.data + strings->offsets[k]) % capacity;
+                while (offsets[j] != UINT32_MAX)
+                {
+                    j = (j + 1) % capacity;
+                }
+                offsets[j] = strings->offsets[k];
+            }
+        }
+        free(strings->offsets);
+        strings->offsets = offsets;
+        strings->capacity = capacity;
+    }
+    k = Hash(string) % strings->capacity;
+    while (strings->offsets[k] != UINT32_MAX)
+    {
+        if (strcmp(strings->buffer.data + strings->offsets[k], string) == 0)
+        {
+            return strings->offsets[k];
+        }
+        k = (k + 1) % strings->capacity;
+    }
+    strings->offsets[k] = (uint32_t)strings->buffer.size;
+    strings->count++;
+    Append(&strings->buffer, string, strlen(string) + 1);
+    return strings->offsets[k];
+}
+
+static size_t Split(char* line, char* fields[])
+{
+    size_t n = 0;
+    char* end = line + strcspn(line, "\r\n");
+    *end = '\0';
+    fields[n++] = line;
+    while (n < MAX_FIELDS && (line = strchr(line, '\t')) != NULL)
+    {
+        *line++ = '\0';
+        fields[n++] = line;
+    }
+    return n;
+}
+
+int main(int argc, char* argv[])
+{
+    FILE* file;
+    char line[MAX_LINE];
+    char* fields[MAX_FIELDS];
+    size_t n, k, lineNumber = 0;
+    struct Buffer instances = {NULL, 0, 0};
+    struct Buffer parameters = {NULL, 0, 0};
+    struct Buffer connections = {NULL, 0, 0};
+    struct Strings strings = {{NULL, 0, 0}, NULL, 0, 0};
+    struct PlanHeader header;
+    struct PlanInstance* instance;
+    struct PlanParameter* sortedParameters;
+    struct PlanConnection* sortedConnections;
+    uint32_t* first;
+    uint32_t numberOfInstances, numberOfParameters, numberOfConnections;
+    static const char padding[8] = {0};
+
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s <plan.txt> <plan>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    file = fopen(argv[1], "r");
+    if (file == NULL)
+    {
+        fprintf(stderr, "%s could not be opened\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+    AddString(&strings, "");
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        lineNumber++;
+        n = Split(line, fields);
+        if (n == 8 && strcmp(fields[0], "instance") == 0)
+        {
+            struct PlanInstance record;
+            memset(&record, 0, sizeof(record));
+            record.instanceName = AddString(&strings, fields[1]);
+            record.guid = AddString(&strings, fields[2]);
+            record.modelIdentifier = AddString(&strings, fields[3]);
+            record.library = AddString(&strings, fields[4]);
+            record.resources = AddString(&strings, fields[5]);
+            record.stepRatio = (uint32_t)strtoul(fields[6], NULL, 10);
+            record.flags = (uint32_t)strtoul(fields[7], NULL, 10);
+            if (record.stepRatio == 0)
+            {
+                fprintf(stderr, "%s:%lu: step ratio has to be positive\n", argv[1], (unsigned long)lineNumber);
+                fclose(file);
+                return EXIT_FAILURE;
+            }
+            Append(&instances, &record, sizeof(record));
+        }
+        else if (n == 5 && strcmp(fields[0], "parameter") == 0)
+        {
+            struct PlanParameter record;
+            memset(&record, 0, sizeof(record));
+            record.instance = (uint32_t)strtoul(fields[1], NULL, 10);
+            record.type = (uint32_t)strtoul(fields[2], NULL, 10);
+            record.valueReference = (uint32_t)strtoul(fields[3], NULL, 10);
+            switch (record.type)
+            {
+            case PlanReal:
+                record.value.real = strtod(fields[4], NULL);
+                break;
+            case PlanInteger:
+            case PlanBoolean:
+                record.value.integer = (int32_t)strtol(fields[4], NULL, 10);
+                break;
+            default:
+                record.value.string = AddString(&strings, fields[4]);
+                break;
+            }
+            Append(&parameters, &record, sizeof(record));
+        }
+        else if (n == 6 && strcmp(fields[0], "connection") == 0)
+        {
+            struct PlanConnection record;
+            memset(&record, 0, sizeof(record));
+            record.type = (uint32_t)strtoul(fields[1], NULL, 10);
+            record.source = (uint32_t)strtoul(fields[2], NULL, 10);
+            record.sourceValueReference = (uint32_t)strtoul(fields[3], NULL, 10);
+            record.destination = (uint32_t)strtoul(fields[4], NULL, 10);
+            record.destinationValueReference = (uint32_t)strtoul(fields[5], NULL, 10);
+            Append(&connections, &record, sizeof(record));
+        }
+        else if (n > 1 || fields[0][0] != '\0')
+        {
+            fprintf(stderr, "%s:%lu: invalid record\n", argv[1], (unsigned long)lineNumber);
+            fclose(file);
+            return EXIT_FAILURE;
+        }
+    }
+    fclose(file);
+
+    numberOfInstances = (uint32_t)(instances.size / sizeof(struct PlanInstance));
+    numberOfParameters = (uint32_t)(parameters.size / sizeof(struct PlanParameter));
+    numberOfConnections = (uint32_t)(connections.size / sizeof(struct PlanConnection));
+    instance = (struct PlanInstance*)instances.data;
+
+    /* Group parameters and connections by instance with a stable counting sort */
+    first = calloc(numberOfInstances + 1, sizeof(uint32_t));
+    sortedParameters = malloc(parameters.size + 1);
+    sortedConnections = malloc(connections.size + 1);
+    if (first == NULL || sortedParameters == NULL || sortedConnections == NULL)
+    {
+        fprintf(stderr, "Out of memory\n");
+        return EXIT_FAILURE;
+    }
+    for (k = 0; k < numberOfParameters; k++)
+    {
+        const struct PlanParameter* parameter = (struct PlanParameter*)parameters.data + k;
+        if (parameter->instance >= numberOfInstances)
+        {
+            fprintf(stderr, "Parameter of unknown instance %lu\n", (unsigned long)parameter->instance);
+            return EXIT_FAILURE;
+        }
+        instance[parameter->instance].numberOfParameters++;
+    }
+    for (k = 0; k < numberOfInstances; k++)
+    {
+        instance[k].firstParameter = k == 0 ? 0 : instance[k - 1].firstParameter + instance[k - 1].numberOfParameters;
+        first[k] = instance[k].firstParameter;
+    }
+    for (k = 0; k < numberOfParameters; k++)
+    {
+        const struct PlanParameter* parameter = (struct PlanParameter*)parameters.data + k;
+        sortedParameters[first[parameter->instance]++] = *parameter;
+    }
+    for (k = 0; k < numberOfConnections; k++)
+    {
+        const struct PlanConnection* connection = (struct PlanConnection*)connections.data + k;
+        if (connection->source >= numberOfInstances || connection->destination >= numberOfInstances)
+        {
+            fprintf(stderr, "Connection of unknown instance\n");
+            return EXIT_FAILURE;
+        }
+        instance[connection->source].numberOfConnections++;
+    }
+    for (k = 0; k < numberOfInstances; k++)
+    {
+        instance[k].firstConnection = k == 0 ? 0 : instance[k - 1].firstConnection + instance[k - 1].numberOfConnections;
+        first[k] = instance[k].firstConnection;
+    }
+    for (k = 0; k < numberOfConnections; k++)
+    {
+        const struct PlanConnection* connection = (struct PlanConnection*)connections.data + k;
+        sortedConnections[first[connection->source]++] = *connection;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic = PLAN_MAGIC;
+    header.version = PLAN_VERSION;
+    header.numberOfInstances = numberOfInstances;
+    header.numberOfParameters = numberOfParameters;
+    header.numberOfConnections = numberOfConnections;
+    header.sizeOfStrings = (uint32_t)strings.buffer.size;
+    header.size = (uint32_t)PLAN_SIZE(numberOfInstances, numberOfParameters, numberOfConnections, header.sizeOfStrings);
+
+    file = fopen(argv[2], "wb");
+    if (file == NULL)
+    {
+        fprintf(stderr, "%s could not be opened\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+    if (fwrite(&header, sizeof(header), 1, file) != 1
+        || fwrite(sortedParameters, 1, parameters.size, file) != parameters.size
+        || fwrite(instances.data, 1, instances.size, file) != instances.size
+        || fwrite(sortedConnections, 1, connections.size, file) != connections.size
+        || fwrite(strings.buffer.data, 1, strings.buffer.size, file) != strings.buffer.size
+        || fwrite(padding, 1, PLAN_ALIGN(header.sizeOfStrings) - header.sizeOfStrings, file)
+            != PLAN_ALIGN(header.sizeOfStrings) - header.sizeOfStrings)
+    {
+        fprintf(stderr, "%s could not be written\n", argv[2]);
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+    fclose(file);
+
+    free(first);
+    free(sortedParameters);
+    free(sortedConnections);
+    free(instances.data);
+    free(parameters.data);
+    free(connections.data);
+    free(strings.buffer.data);
+    free(strings.offsets);
+    return EXIT_SUCCESS;
+}
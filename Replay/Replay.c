@@ -0,0 +1,492 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Slaven Glumac
+ *
+ * Drives an FMU library with the calls recorded by an FMU built with
+ * FMU_RECORD, see recording.h, without a master and its other FMUs:
+ * Replay <library> <recording> [loops] [resources]
+ *
+ * The recording is replayed loops times (1 by default) on one instance,
+ * which is reset between the loops. Replay prints the time the loops took
+ * and the largest difference between the values got and the recorded ones,
+ * which is 0 when the library behaves as the recorded one. States the
+ * recording does not free are freed at the end of every loop.
+ */
+#include <recording.h>
+#include <fmi2Functions.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#include <time.h>
+#endif
+
+struct Library
+{
+    fmi2InstantiateTYPE* instantiate;
+    fmi2FreeInstanceTYPE* freeInstance;
+    fmi2SetupExperimentTYPE* setupExperiment;
+    fmi2EnterInitializationModeTYPE* enterInitializationMode;
+    fmi2ExitInitializationModeTYPE* exitInitializationMode;
+    fmi2TerminateTYPE* terminate;
+    fmi2ResetTYPE* reset;
+    fmi2SetRealTYPE* setReal;
+    fmi2SetIntegerTYPE* setInteger;
+    fmi2SetBooleanTYPE* setBoolean;
+    fmi2SetRealInputDerivativesTYPE* setRealInputDerivatives;
+    fmi2DoStepTYPE* doStep;
+    fmi2GetRealTYPE* getReal;
+    fmi2GetRealOutputDerivativesTYPE* getRealOutputDerivatives;
+    fmi2GetFMUstateTYPE* getFMUstate;
+    fmi2SetFMUstateTYPE* setFMUstate;
+    fmi2FreeFMUstateTYPE* freeFMUstate;
+    fmi2DeSerializeFMUstateTYPE* deSerializeFMUstate;
+};
+
+/* States of the replay by the address they had in the recorded run */
+struct States
+{
+    uint64_t* recorded;
+    fmi2FMUstate* states;
+    size_t count;
+    size_t capacity;
+};
+
+/* Stores the address of the function name into the function pointer at pointer */
+static void Function(void* library, const char* name, void* pointer)
+{
+    void* function;
+#ifdef _WIN32
+    function = (void*)GetProcAddress((HMODULE)library, name);
+#else
+    function = dlsym(library, name);
+#endif
+    if (function == NULL)
+    {
+        fprintf(stderr, "%s is not found in the library\n", name);
+        exit(EXIT_FAILURE);
+    }
+    /* ISO C has no conversion from an object to a function pointer */
+    memcpy(pointer, &function, sizeof(function));
+}
+
+static void Load(const char* path, struct Library* library)
+{
+    void* handle;
+#ifdef _WIN32
+    handle = (void*)LoadLibraryA(path);
+#else
+    handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+#endif
+    if (handle == NULL)
+    {
+        fprintf(stderr, "%s could not be loaded\n", path);
+        exit(EXIT_FAILURE);
+    }
+    Function(handle, "fmi2Instantiate", &library->instantiate);
+    Function(handle, "fmi2FreeInstance", &library->freeInstance);
+    Function(handle, "fmi2SetupExperiment", &library->setupExperiment);
+    Function(handle, "fmi2EnterInitializationMode", &library->enterInitializationMode);
+    Function(handle, "fmi2ExitInitializationMode", &library->exitInitializationMode);
+    Function(handle, "fmi2Terminate", &library->terminate);
+    Function(handle, "fmi2Reset", &library->reset);
+    Function(handle, "fmi2SetReal", &library->setReal);
+    Function(handle, "fmi2SetInteger", &library->setInteger);
+    Function(handle, "fmi2SetBoolean", &library->setBoolean);
+    Function(handle, "fmi2SetRealInputDerivatives", &library->setRealInputDerivatives);
+    Function(handle, "fmi2DoStep", &library->doStep);
+    Function(handle, "fmi2GetReal", &library->getReal);
+    Function(handle, "fmi2GetRealOutputDerivatives", &library->getRealOutputDerivatives);
+    Function(handle, "fmi2GetFMUstate", &library->getFMUstate);
+    Function(handle, "fmi2SetFMUstate", &library->setFMUstate);
+    Function(handle, "fmi2FreeFMUstate", &library->freeFMUstate);
+    Function(handle, "fmi2DeSerializeFMUstate", &library->deSerializeFMUstate);
+}
+
+/* Returns the state recorded at the address recorded, a new empty one if add is set or NULL */
+static fmi2FMUstate* FindState(struct States* states, uint64_t recorded, int add)
+{
+    size_t k;
+    for (k = 0; k < states->count; k++)
+    {
+        if (states->recorded[k] == recorded)
+        {
+            return &states->states[k];
+        }
+    }
+    if (!add)
+    {
+        return NULL;
+    }
+    if (states->count == states->capacity)
+    {
+        states->capacity = states->capacity == 0 ? 16 : 2 * states->capacity;
+        states->recorded = realloc(states->recorded, states->capacity * sizeof(uint64_t));
+        states->states = realloc(states->states, states->capacity * sizeof(fmi2FMUstate));
+        if (states->recorded == NULL || states->states == NULL)
+        {
+            fprintf(stderr, "Out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    states->recorded[states->count] = recorded;
+    states->states[states->count] = NULL;
+    return &states->states[states->count++];
+}
+
+static void RemoveState(struct States* states, fmi2FMUstate* state)
+{
+    size_t k = (size_t)(state - states->states);
+    states->count--;
+    states->recorded[k] = states->recorded[states->count];
+    states->states[k] = states->states[states->count];
+}
+
+static void FreeStates(const struct Library* library, fmi2Component component, struct States* states)
+{
+    size_t k;
+    for (k = 0; k < states->count; k++)
+    {
+        library->freeFMUstate(component, &states->states[k]);
+    }
+    states->count = 0;
+}
+
+/* Reads the whole recording into memory allocated with malloc, so the records stay aligned */
+static char* Read(const char* path, size_t* size)
+{
+    FILE* file = fopen(path, "rb");
+    char* data;
+    long length;
+    if (file == NULL || fseek(file, 0, SEEK_END) != 0 || (length = ftell(file)) < 0)
+    {
+        fprintf(stderr, "%s could not be read\n", path);
+        exit(EXIT_FAILURE);
+    }
+    rewind(file);
+    data = malloc((size_t)length + 1);
+    if (data == NULL || fread(data, 1, (size_t)length, file) != (size_t)length)
+    {
+        fprintf(stderr, "%s could not be read\n", path);
+        exit(EXIT_FAILURE);
+    }
+    fclose(file);
+    *size = (size_t)length;
+    return data;
+}
+
+/* Bytes of the data following a record of type with count value references */
+static size_t Payload(uint32_t type, uint32_t count)
+{
+    switch (type)
+    {
+    case RecordSetupExperiment:
+        return sizeof(struct RecordExperiment);
+    case RecordSetReal:
+    case RecordGetReal:
+        return count * (sizeof(double) + sizeof(uint32_t));
+    case RecordSetInteger:
+    case RecordSetBoolean:
+        return count * (sizeof(uint32_t) + sizeof(int32_t));
+    case RecordSetRealInputDerivatives:
+    case RecordGetRealOutputDerivatives:
+        return count * (sizeof(double) + sizeof(uint32_t) + sizeof(int32_t));
+    case RecordDoStep:
+        return sizeof(struct RecordStep);
+    case RecordGetFMUstate:
+    case RecordSetFMUstate:
+    case RecordFreeFMUstate:
+        return sizeof(uint64_t);
+    case RecordDeSerializeFMUstate:
+        return sizeof(uint64_t) + count;
+    default:
+        return 0;
+    }
+}
+
+/* Checks the records once, so the replay itself does not have to */
+static size_t Validate(char* recording, size_t size, size_t* numberOfCalls)
+{
+    struct RecordingHeader* header = (struct RecordingHeader*)recording;
+    size_t offset = sizeof(struct RecordingHeader);
+    size_t maximumCount = 1;
+    if (size < sizeof(struct RecordingHeader) || header->magic != RECORDING_MAGIC)
+    {
+        fprintf(stderr, "The file is not a recording\n");
+        exit(EXIT_FAILURE);
+    }
+    if (header->version != RECORDING_VERSION)
+    {
+        fprintf(stderr, "The recording has version %u instead of %u\n", header->version, RECORDING_VERSION);
+        exit(EXIT_FAILURE);
+    }
+    header->guid[RECORDING_GUID_SIZE - 1] = '\0';
+    header->instanceName[RECORDING_NAME_SIZE - 1] = '\0';
+    *numberOfCalls = 0;
+    while (offset + sizeof(struct Record) <= size)
+    {
+        const struct Record* record = (const struct Record*)(recording + offset);
+        if (record->size < sizeof(struct Record) || record->size % 8 != 0 || record->size > size - offset
+            || record->type < RecordSetupExperiment || record->type > RecordDeSerializeFMUstate
+            || Payload(record->type, record->count) > record->size - sizeof(struct Record))
+        {
+            fprintf(stderr, "The recording is corrupt at byte %lu\n", (unsigned long)offset);
+            exit(EXIT_FAILURE);
+        }
+        if (record->type != RecordDeSerializeFMUstate && record->count > maximumCount)
+        {
+            maximumCount = record->count;
+        }
+        offset += record->size;
+        (*numberOfCalls)++;
+    }
+    return maximumCount;
+}
+
+static void Logger(fmi2ComponentEnvironment environment, fmi2String instanceName, fmi2Status status, fmi2String category, fmi2String message, ...)
+{
+    va_list arguments;
+    va_start(arguments, message);
+    fprintf(stderr, "%s: ", instanceName);
+    vfprintf(stderr, message, arguments);
+    fputc('\n', stderr);
+    va_end(arguments);
+}
+
+static double Now(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec + 1e-9 * (double)now.tv_nsec;
+#endif
+}
+
+/* Replays all records once and returns the status of the first call which failed or fmi2OK */
+static fmi2Status Replay
+    ( const struct Library* library
+    , fmi2Component component
+    , const char* recording
+    , size_t size
+    , struct States* states
+    , fmi2Real values[]
+    , double* deviation)
+{
+    size_t offset = sizeof(struct RecordingHeader);
+    while (offset + sizeof(struct Record) <= size)
+    {
+        const struct Record* record = (const struct Record*)(recording + offset);
+        const char* data = (const char*)(record + 1);
+        /* Records with reals hold them first, then the value references and the orders */
+        const double* reals = (const double*)data;
+        const fmi2ValueReference* vr = NULL;
+        const fmi2Integer* orders = NULL;
+        fmi2FMUstate* state = NULL;
+        fmi2Status status = fmi2OK;
+        size_t i;
+        switch (record->type)
+        {
+        case RecordGetFMUstate:
+        case RecordDeSerializeFMUstate:
+            state = FindState(states, *(const uint64_t*)data, 1);
+            break;
+        case RecordSetFMUstate:
+        case RecordFreeFMUstate:
+            state = FindState(states, *(const uint64_t*)data, 0);
+            if (state == NULL)
+            {
+                fprintf(stderr, "Record at byte %lu uses a state which was not recorded\n", (unsigned long)offset);
+                return fmi2Error;
+            }
+            break;
+        case RecordSetReal:
+        case RecordGetReal:
+            vr = (const fmi2ValueReference*)(reals + record->count);
+            break;
+        case RecordSetRealInputDerivatives:
+        case RecordGetRealOutputDerivatives:
+            vr = (const fmi2ValueReference*)(reals + record->count);
+            orders = (const fmi2Integer*)(vr + record->count);
+            break;
+        default:
+            break;
+        }
+        switch (record->type)
+        {
+        case RecordSetupExperiment:
+        {
+            const struct RecordExperiment* experiment = (const struct RecordExperiment*)data;
+            status = library->setupExperiment(component
+                , experiment->toleranceDefined, experiment->tolerance
+                , experiment->startTime
+                , experiment->stopTimeDefined, experiment->stopTime);
+            break;
+        }
+        case RecordEnterInitializationMode:
+            status = library->enterInitializationMode(component);
+            break;
+        case RecordExitInitializationMode:
+            status = library->exitInitializationMode(component);
+            break;
+        case RecordSetReal:
+            status = library->setReal(component, vr, record->count, reals);
+            break;
+        case RecordSetInteger:
+            status = library->setInteger(component, (const fmi2ValueReference*)data, record->count
+                , (const fmi2Integer*)data + record->count);
+            break;
+        case RecordSetBoolean:
+            status = library->setBoolean(component, (const fmi2ValueReference*)data, record->count
+                , (const fmi2Boolean*)data + record->count);
+            break;
+        case RecordSetRealInputDerivatives:
+            status = library->setRealInputDerivatives(component, vr, record->count, orders, reals);
+            break;
+        case RecordDoStep:
+        {
+            const struct RecordStep* step = (const struct RecordStep*)data;
+            status = library->doStep(component
+                , step->currentCommunicationPoint
+                , step->communicationStepSize
+                , step->noSetFMUStatePriorToCurrentPoint);
+            break;
+        }
+        case RecordGetReal:
+        case RecordGetRealOutputDerivatives:
+            if (record->type == RecordGetReal)
+            {
+                status = library->getReal(component, vr, record->count, values);
+            }
+            else
+            {
+                status = library->getRealOutputDerivatives(component, vr, record->count, orders, values);
+            }
+            /* The values are undefined unless the call succeeded */
+            if (status == fmi2OK || status == fmi2Warning)
+            {
+                for (i = 0; i < record->count; i++)
+                {
+                    double difference = fabs(values[i] - reals[i]);
+                    if (difference != difference)
+                    {
+                        difference = HUGE_VAL;
+                    }
+                    if (difference > *deviation)
+                    {
+                        *deviation = difference;
+                    }
+                }
+            }
+            break;
+        case RecordTerminate:
+            status = library->terminate(component);
+            break;
+        case RecordReset:
+            status = library->reset(component);
+            break;
+        case RecordGetFMUstate:
+            status = library->getFMUstate(component, state);
+            break;
+        case RecordSetFMUstate:
+            status = library->setFMUstate(component, *state);
+            break;
+        case RecordFreeFMUstate:
+            status = library->freeFMUstate(component, state);
+            RemoveState(states, state);
+            break;
+        case RecordDeSerializeFMUstate:
+            status = library->deSerializeFMUstate(component, data + sizeof(uint64_t), record->count, state);
+            break;
+        default:
+            break;
+        }
+        if (status != fmi2OK && status != fmi2Warning)
+        {
+            fprintf(stderr, "Record at byte %lu failed with status %d\n", (unsigned long)offset, (int)status);
+            return status;
+        }
+        offset += record->size;
+    }
+    return fmi2OK;
+}
+
+int main(int argc, char** argv)
+{
+    fmi2CallbackFunctions callbacks = {Logger, calloc, free, NULL, NULL};
+    struct Library library;
+    struct States states = {NULL, NULL, 0, 0};
+    const struct RecordingHeader* header;
+    fmi2Component component;
+    fmi2Real* values;
+    char* recording;
+    size_t size;
+    size_t numberOfCalls;
+    long loops = 1;
+    long loop;
+    double deviation = 0.;
+    double start;
+    double time;
+    if (argc < 3 || argc > 5)
+    {
+        fprintf(stderr, "Usage: Replay <library> <recording> [loops] [resources]\n");
+        return EXIT_FAILURE;
+    }
+    if (argc > 3)
+    {
+        loops = strtol(argv[3], NULL, 10);
+        if (loops < 1)
+        {
+            fprintf(stderr, "loops has to be a positive integer\n");
+            return EXIT_FAILURE;
+        }
+    }
+    Load(argv[1], &library);
+    recording = Read(argv[2], &size);
+    header = (const struct RecordingHeader*)recording;
+    values = malloc(Validate(recording, size, &numberOfCalls) * sizeof(fmi2Real));
+    component = library.instantiate(header->instanceName, fmi2CoSimulation, header->guid
+        , argc > 4 ? argv[4] : "", &callbacks, fmi2False, fmi2False);
+    if (values == NULL || component == NULL)
+    {
+        fprintf(stderr, "%s could not be instantiated\n", header->instanceName);
+        return EXIT_FAILURE;
+    }
+    start = Now();
+    for (loop = 0; loop < loops; loop++)
+    {
+        if ((loop > 0 && library.reset(component) != fmi2OK)
+            || Replay(&library, component, recording, size, &states, values, &deviation) != fmi2OK)
+        {
+            FreeStates(&library, component, &states);
+            library.freeInstance(component);
+            return EXIT_FAILURE;
+        }
+        FreeStates(&library, component, &states);
+    }
+    time = Now() - start;
+    library.freeInstance(component);
+    printf("%s: %ld loops of %lu calls in %.6f s, %.3f us per loop, deviation %g\n"
+        , header->instanceName
+        , loops
+        , (unsigned long)numberOfCalls
+        , time
+        , 1e6 * time / (double)loops
+        , deviation);
+    free(states.recorded);
+    free(states.states);
+    free(values);
+    free(recording);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+# On-disk cache of simulation results keyed by everything that determines them.
+#
+# cmake -D ACTION=key|lookup|store [-D KEY=<key>]
+#       [-D CONFIGURATION=<configuration.xml>] [-D FMU_PATH=<directories>]
+#       [-D PARAMETERS=<overrides>] [-D STEP_SIZE=<h>] [-D ORDER=<order>]
+#       [-D TOLERANCE=<tolerance>] [-D SETTINGS=<other settings>]
+#       [-D MASTER=<master executable>]
+#       [-D RESULT=<result file>] [-D OUTPUT=<result file>]
+#       [-D CACHE_DIRECTORY=<cache>] [-D MAX_SIZE=<bytes>]
+#       -P ResultCache.cmake
+#
+# key    prints the key, the SHA-256 of the configuration, of every archive it
+#        references (searched in FMU_PATH, the directory of the configuration
+#        by default), of MASTER and of the remaining settings
+# lookup copies the result stored under the key to OUTPUT, fails on a miss
+# store  stores RESULT under the key and evicts the least recently used
+#        results until the cache holds at most MAX_SIZE bytes
+# Without KEY, lookup and store compute the key like key does.
+#
+# The cache defaults to the environment variable FMU_RESULT_CACHE_DIRECTORY
+# or to results in the working directory, MAX_SIZE to the environment
+# variable FMU_RESULT_CACHE_SIZE or to 1 GiB. Each result is kept in
+# <cache>/<key>/result next to key.txt, the description of what was hashed,
+# or only the key if it was given as KEY.
+# A hit touches the result, so its modification time orders the eviction.
+
+cmake_minimum_required(VERSION 3.14)
+
+function(ResultKey key)
+    if (NOT DEFINED CONFIGURATION)
+        message(FATAL_ERROR "CONFIGURATION is not set")
+    endif()
+    get_filename_component(configuration "${CONFIGURATION}" ABSOLUTE)
+    if (NOT DEFINED FMU_PATH)
+        get_filename_component(FMU_PATH "${configuration}" DIRECTORY)
+    endif()
+    file(SHA256 "${configuration}" hash)
+    set(description "configuration\t${hash}\n")
+    file(READ "${configuration}" xml)
+    string(REGEX MATCHALL "<Archive[ \t\r\n][^>]*archiveName=\"[^\"]*\"" archives "${xml}")
+    list(REMOVE_DUPLICATES archives)
+    foreach(archive ${archives})
+        string(REGEX MATCH "archiveName=\"([^\"]*)\"" match "${archive}")
+        set(archive "${CMAKE_MATCH_1}")
+        unset(archivePath)
+        foreach(directory ${FMU_PATH})
+            if (NOT DEFINED archivePath AND EXISTS "${directory}/${archive}")
+                set(archivePath "${directory}/${archive}")
+            endif()
+        endforeach()
+        if (NOT DEFINED archivePath)
+            message(FATAL_ERROR "${archive} is not found in ${FMU_PATH}")
+        endif()
+        file(SHA256 "${archivePath}" hash)
+        string(APPEND description "archive\t${archive}\t${hash}\n")
+    endforeach()
+    if (DEFINED MASTER)
+        file(SHA256 "${MASTER}" hash)
+        string(APPEND description "master\t${hash}\n")
+    endif()
+    foreach(setting PARAMETERS STEP_SIZE ORDER TOLERANCE SETTINGS)
+        string(APPEND description "${setting}\t${${setting}}\n")
+    endforeach()
+    string(SHA256 hash "${description}")
+    set(${key} "${hash}" PARENT_SCOPE)
+    set(${key}.description "${description}" PARENT_SCOPE)
+endfunction()
+
+# Removes the least recently used results except keep until the cache fits into maxSize
+function(EvictResults cache maxSize keep)
+    file(GLOB results "${cache}/*/result")
+    set(entries "")
+    set(size 0)
+    foreach(result ${results})
+        file(SIZE "${result}" resultSize)
+        file(TIMESTAMP "${result}" time "%s" UTC)
+        get_filename_component(entry "${result}" DIRECTORY)
+        # Zero padded, so the lexicographic order is the order in time
+        string(LENGTH "${time}" length)
+        while (length LESS 12)
+            set(time "0${time}")
+            math(EXPR length "${length} + 1")
+        endwhile()
+        list(APPEND entries "${time}|${resultSize}|${entry}")
+        math(EXPR size "${size} + ${resultSize}")
+    endforeach()
+    list(SORT entries)
+    foreach(entry ${entries})
+        if (NOT size GREATER maxSize)
+            break()
+        endif()
+        string(REPLACE "|" ";" fields "${entry}")
+        list(GET fields 1 resultSize)
+        list(GET fields 2 directory)
+        get_filename_component(name "${directory}" NAME)
+        if (NOT name STREQUAL keep)
+            file(REMOVE_RECURSE "${directory}")
+            math(EXPR size "${size} - ${resultSize}")
+        endif()
+    endforeach()
+endfunction()
+
+if (NOT DEFINED ACTION)
+    message(FATAL_ERROR "ACTION is not set")
+endif()
+if (NOT DEFINED CACHE_DIRECTORY)
+    if (DEFINED ENV{FMU_RESULT_CACHE_DIRECTORY})
+        set(CACHE_DIRECTORY "$ENV{FMU_RESULT_CACHE_DIRECTORY}")
+    else()
+        set(CACHE_DIRECTORY results)
+    endif()
+endif()
+get_filename_component(CACHE_DIRECTORY "${CACHE_DIRECTORY}" ABSOLUTE)
+if (NOT DEFINED MAX_SIZE)
+    if (DEFINED ENV{FMU_RESULT_CACHE_SIZE})
+        set(MAX_SIZE "$ENV{FMU_RESULT_CACHE_SIZE}")
+    else()
+        set(MAX_SIZE 1073741824)
+    endif()
+endif()
+if (NOT DEFINED KEY OR ACTION STREQUAL "key")
+    ResultKey(KEY)
+endif()
+set(entry "${CACHE_DIRECTORY}/${KEY}")
+
+if (ACTION STREQUAL "key")
+    execute_process(COMMAND ${CMAKE_COMMAND} -E echo "${KEY}")
+elseif (ACTION STREQUAL "lookup")
+    if (NOT DEFINED OUTPUT)
+        message(FATAL_ERROR "OUTPUT is not set")
+    endif()
+    if (NOT EXISTS "${entry}/result")
+        message(FATAL_ERROR "${KEY} is not cached")
+    endif()
+    # The result could be evicted by another process meanwhile, which is a miss as well
+    execute_process(COMMAND ${CMAKE_COMMAND} -E copy "${entry}/result" "${OUTPUT}" RESULT_VARIABLE result)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "${KEY} is not cached")
+    endif()
+    # Evicted after the copy the hit stands, there is just nothing to touch
+    file(TOUCH_NOCREATE "${entry}/result")
+elseif (ACTION STREQUAL "store")
+    if (NOT DEFINED RESULT OR NOT EXISTS "${RESULT}")
+        message(FATAL_ERROR "RESULT is not set or does not exist")
+    endif()
+    file(MAKE_DIRECTORY "${CACHE_DIRECTORY}")
+    file(LOCK "${CACHE_DIRECTORY}/.lock" TIMEOUT 600 RESULT_VARIABLE result)
+    if (NOT result EQUAL 0)
+        message(FATAL_ERROR "${CACHE_DIRECTORY}/.lock could not be locked: ${result}")
+    endif()
+    if (NOT EXISTS "${entry}/result")
+        set(partial "${entry}.partial")
+        file(REMOVE_RECURSE "${partial}")
+        file(MAKE_DIRECTORY "${partial}")
+        if (DEFINED KEY.description)
+            file(WRITE "${partial}/key.txt" "${KEY.description}")
+        else()
+            file(WRITE "${partial}/key.txt" "key\t${KEY}\n")
+        endif()
+        execute_process(COMMAND ${CMAKE_COMMAND} -E copy "${RESULT}" "${partial}/result" RESULT_VARIABLE result)
+        if (NOT result EQUAL 0)
+            file(REMOVE_RECURSE "${partial}")
+            message(FATAL_ERROR "${RESULT} could not be stored")
+        endif()
+        file(REMOVE_RECURSE "${entry}")
+        file(RENAME "${partial}" "${entry}")
+    else()
+        file(TOUCH "${entry}/result")
+    endif()
+    EvictResults("${CACHE_DIRECTORY}" "${MAX_SIZE}" "${KEY}")
+    file(LOCK "${CACHE_DIRECTORY}/.lock" RELEASE)
+else()
+    message(FATAL_ERROR "Unknown ACTION ${ACTION}")
+endif()
@@ -11,12 +11,16 @@
  */
 #include <fmi2Functions.h>
 #include <math.h>
+#include <blocks.h>
 
 #define MAX_INPUT_DERIVATIVE_ORDER 10
+#define MAX_OUTPUT_DERIVATIVE_ORDER MAX_INPUT_DERIVATIVE_ORDER
+#define HAS_TIME_EVENTS 1
 #define NUMBER_OF_REALS 4
 #define NUMBER_OF_INTEGERS 0
 #define NUMBER_OF_BOOLEANS 0
 #define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_INTERNAL_STATES 0
 
 const fmi2ValueReference ivrs[] = {0, 1, 2, 3};
 
@@ -44,22 +48,19 @@ void FreeInternal(fmi2Component component)
 
 void StartInitialization(fmi2Component component)
 {
-    _y = 0.;
-    _y0 = 1.;
-    _yEnd = 1.;
-    _tStep = 1.;
+    BlockEvaluate(component, StepStart, 0.);
     logf(fmi2OK, "y = %lf, y0 = %lf, yEnd = %lf, _tStep = %lf", _y, _y0, _yEnd, _tStep);
 }
 
 fmi2Status FinishInitialization(fmi2Component component)
 {
-    _y = _t < _tStep ? _y0 : _yEnd;
+    BlockEvaluate(component, StepUpdate, 0.);
     return fmi2OK;
 }
 
 fmi2Status StateUpdate(fmi2Component component, fmi2Real h)
 {
-    _y = _t + h < _tStep ? _y0 : _yEnd;
+    BlockEvaluate(component, StepUpdate, h);
     logf(fmi2OK, "y = %lf, y0 = %lf, yEnd = %lf, _tStep = %lf", _y, _y0, _yEnd, _tStep);
     return fmi2OK;
 }
@@ -68,3 +69,33 @@ fmi2Status OutputUpdate(fmi2Component component)
 {
 	return fmi2OK;
 }
+
+fmi2Boolean NextEventTime(fmi2Component component, fmi2Real* time)
+{
+    if (_t < _tStep)
+    {
+        *time = _tStep;
+        return fmi2True;
+    }
+    return fmi2False;
+}
+
+/* The output is piecewise constant */
+fmi2Status OutputDerivative(fmi2Component component, fmi2ValueReference vr, fmi2Integer order, fmi2Real* value)
+{
+    if (vr != 0)
+    {
+        return fmi2Error;
+    }
+    *value = 0.;
+    return fmi2OK;
+}
+
+void SaveInternal(fmi2Component component, fmi2Real state[])
+{
+}
+
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[])
+{
+    return fmi2OK;
+}
@@ -9,12 +9,15 @@
  */
 #include <fmi2Functions.h>
 #include <math.h>
+#include <blocks.h>
 
 #define MAX_INPUT_DERIVATIVE_ORDER 10
+#define MAX_OUTPUT_DERIVATIVE_ORDER MAX_INPUT_DERIVATIVE_ORDER
 #define NUMBER_OF_REALS 3
 #define NUMBER_OF_INTEGERS 0
 #define NUMBER_OF_BOOLEANS 0
 #define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_INTERNAL_STATES 0
 
 const fmi2ValueReference ivrs[] = {0, 1, 2};
 
@@ -41,20 +44,18 @@ void FreeInternal(fmi2Component component)
 
 void StartInitialization(fmi2Component component)
 {
-    _u1 = 0.;
-    _u2 = 0.;
-    _y = 0.;
+    BlockEvaluate(component, SubtractionStart, 0.);
 }
 
 fmi2Status FinishInitialization(fmi2Component component)
 {
-    _y = _u1 - _u2;
+    BlockEvaluate(component, SubtractionUpdate, 0.);
     return fmi2OK;
 }
 
 fmi2Status StateUpdate(fmi2Component component, fmi2Real h)
 {
-    _y = _u1 - _u2;
+    BlockEvaluate(component, SubtractionUpdate, h);
     logf(fmi2OK, "u1 = %lf, u2 = %lf, y = %lf", _u1, _u2, _y);
     return fmi2OK;
 }
@@ -63,3 +64,22 @@ fmi2Status OutputUpdate(fmi2Component component)
 {
 	return fmi2OK;
 }
+
+fmi2Status OutputDerivative(fmi2Component component, fmi2ValueReference vr, fmi2Integer order, fmi2Real* value)
+{
+    if (vr != 2)
+    {
+        return fmi2Error;
+    }
+    *value = r(0,order) - r(1,order);
+    return fmi2OK;
+}
+
+void SaveInternal(fmi2Component component, fmi2Real state[])
+{
+}
+
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[])
+{
+    return fmi2OK;
+}
@@ -8,12 +8,15 @@
  */
 #include <fmi2Functions.h>
 #include <math.h>
+#include <blocks.h>
 
 #define MAX_INPUT_DERIVATIVE_ORDER 10
+#define MAX_OUTPUT_DERIVATIVE_ORDER MAX_INPUT_DERIVATIVE_ORDER
 #define NUMBER_OF_REALS 1
 #define NUMBER_OF_INTEGERS 0
 #define NUMBER_OF_BOOLEANS 0
 #define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_INTERNAL_STATES 0
 
 const fmi2ValueReference ivrs[] = {0};
 
@@ -38,7 +41,7 @@ void FreeInternal(fmi2Component component)
 
 void StartInitialization(fmi2Component component)
 {
-    _y = 0.;
+    BlockEvaluate(component, ZeroStart, 0.);
 }
 
 fmi2Status FinishInitialization(fmi2Component component)
@@ -55,3 +58,23 @@ fmi2Status OutputUpdate(fmi2Component component)
 {
 	return fmi2OK;
 }
+
+/* The output is piecewise constant */
+fmi2Status OutputDerivative(fmi2Component component, fmi2ValueReference vr, fmi2Integer order, fmi2Real* value)
+{
+    if (vr != 0)
+    {
+        return fmi2Error;
+    }
+    *value = 0.;
+    return fmi2OK;
+}
+
+void SaveInternal(fmi2Component component, fmi2Real state[])
+{
+}
+
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[])
+{
+    return fmi2OK;
+}
@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Slaven Glumac
+ *
+ * Native equivalents of the trivial FMUs Gain, Subtraction, Step and Zero.
+ * A master recognizes their archives by modelIdentifier and GUID with
+ * BlockFind and evaluates the block directly instead of going through
+ * fmi2SetReal, fmi2DoStep and fmi2GetReal. The outputs are then plain
+ * doubles the connections can read in place.
+ *
+ * A block works on the reals of one instance indexed by their value
+ * references, so the value references of a plan apply unchanged. Each
+ * function mirrors the corresponding hook of the FMU and may be NULL if
+ * the FMU does nothing there:
+ * start      StartInitialization, sets the start values
+ * initialize FinishInitialization at time, h is 0
+ * doStep     fmi2DoStep from time by h
+ * output     OutputUpdate, before the outputs are read
+ * The FMUs include this header and call the same functions in their hooks,
+ * so a block always behaves like the FMU it replaces.
+ */
+#ifndef BLOCKS_H
+#define BLOCKS_H
+
+#include <stddef.h>
+#include <string.h>
+
+typedef void (*BlockFunction)(double reals[], double time, double h);
+
+struct Block
+{
+    const char* modelIdentifier;
+    const char* guid;
+    size_t numberOfReals;
+    BlockFunction start;
+    BlockFunction initialize;
+    BlockFunction doStep;
+    BlockFunction output;
+};
+
+/* Gain: u = 0, y = 1, K = 2 */
+static void GainStart(double reals[], double time, double h)
+{
+    (void)time;
+    (void)h;
+    reals[0] = 0.;
+    reals[2] = 1.;
+}
+
+static void GainOutput(double reals[], double time, double h)
+{
+    (void)time;
+    (void)h;
+    reals[1] = reals[2] * reals[0];
+}
+
+/* Subtraction: u1 = 0, u2 = 1, y = 2 */
+static void SubtractionStart(double reals[], double time, double h)
+{
+    (void)time;
+    (void)h;
+    reals[0] = 0.;
+    reals[1] = 0.;
+    reals[2] = 0.;
+}
+
+static void SubtractionUpdate(double reals[], double time, double h)
+{
+    (void)time;
+    (void)h;
+    reals[2] = reals[0] - reals[1];
+}
+
+/* Step: y = 0, y0 = 1, yEnd = 2, tStep = 3 */
+static void StepStart(double reals[], double time, double h)
+{
+    (void)time;
+    (void)h;
+    reals[0] = 0.;
+    reals[1] = 1.;
+    reals[2] = 1.;
+    reals[3] = 1.;
+}
+
+static void StepUpdate(double reals[], double time, double h)
+{
+    reals[0] = time + h < reals[3] ? reals[1] : reals[2];
+}
+
+/* Zero: y = 0 */
+static void ZeroStart(double reals[], double time, double h)
+{
+    (void)time;
+    (void)h;
+    reals[0] = 0.;
+}
+
+static const struct Block blocks[] =
+{
+    {"Gain", "{a0f07710-a502-4c14-a85b-4114f6c3c629}", 3, GainStart, GainOutput, NULL, GainOutput},
+    {"Subtraction", "{d7388eeb-70d8-46bf-a93b-e0fa5209df1b}", 3, SubtractionStart, SubtractionUpdate, SubtractionUpdate, NULL},
+    {"Step", "{1bceaf20-7e45-4a38-80eb-4217760e5007}", 4, StepStart, StepUpdate, StepUpdate, NULL},
+    {"Zero", "{80824c22-42a0-4f5b-9a3a-7d0a2f9311dc}", 1, ZeroStart, NULL, NULL, NULL}
+};
+
+/* Returns the block replacing the FMU or NULL if there is none */
+static inline const struct Block* BlockFind(const char* modelIdentifier, const char* guid)
+{
+    size_t k;
+    for (k = 0; k < sizeof(blocks) / sizeof(blocks[0]); k++)
+    {
+        if (strcmp(blocks[k].modelIdentifier, modelIdentifier) == 0 && strcmp(blocks[k].guid, guid) == 0)
+        {
+            return &blocks[k];
+        }
+    }
+    return NULL;
+}
+
+#endif
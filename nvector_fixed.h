@@ -0,0 +1,368 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Slaven Glumac
+ *
+ * N_Vector of the compile time length NVECTOR_FIXED_LENGTH for models with
+ * a few states. The vector header, its content and the data are stored in one
+ * struct FixedVector, so a vector can live inside struct Internal and clones
+ * made by CVODE take a single allocation. All vectors share one operation
+ * table and the loops have a constant trip count the compiler unrolls.
+ *
+ * The content is laid out as in NVECTOR_SERIAL, so NV_Ith_S, NV_DATA_S and
+ * NV_LENGTH_S can be used on these vectors.
+ *
+ * Define NVECTOR_FIXED_LENGTH before including this header:
+ * #define NVECTOR_FIXED_LENGTH NUMBER_OF_STATES
+ * #include <nvector_fixed.h>
+ */
+#ifndef NVECTOR_FIXED_H
+#define NVECTOR_FIXED_H
+
+#include <math.h>
+#include <float.h>
+#include <stdlib.h>
+#include <sundials/sundials_nvector.h>
+#include <nvector/nvector_serial.h>
+
+#ifndef NVECTOR_FIXED_LENGTH
+#error NVECTOR_FIXED_LENGTH has to be defined before including nvector_fixed.h
+#endif
+
+#define NF_LOOP(k) for (k = 0; k < NVECTOR_FIXED_LENGTH; k++)
+#define NF_DATA(v) NV_DATA_S(v)
+
+struct FixedVector
+{
+    struct _generic_N_Vector vector;
+    struct _N_VectorContent_Serial content;
+    booleantype allocated;
+    realtype data[NVECTOR_FIXED_LENGTH];
+};
+
+static struct _generic_N_Vector_Ops FixedVectorOps;
+
+/* Prepares storage, e.g. a member of struct Internal, as a vector */
+static N_Vector N_VMake_Fixed(struct FixedVector* storage)
+{
+    storage->vector.content = &storage->content;
+    storage->vector.ops = &FixedVectorOps;
+    storage->content.length = NVECTOR_FIXED_LENGTH;
+    storage->content.own_data = FALSE;
+    storage->content.data = storage->data;
+    storage->allocated = FALSE;
+    return &storage->vector;
+}
+
+static N_Vector N_VNewEmpty_Fixed(void)
+{
+    struct FixedVector* storage = malloc(sizeof(struct FixedVector));
+    if (storage == NULL)
+    {
+        return NULL;
+    }
+    N_VMake_Fixed(storage);
+    storage->allocated = TRUE;
+    return &storage->vector;
+}
+
+static void N_VDestroy_Fixed(N_Vector v)
+{
+    struct FixedVector* storage = (struct FixedVector*)v;
+    if (storage != NULL && storage->allocated)
+    {
+        free(storage);
+    }
+}
+
+static N_Vector_ID N_VGetVectorID_Fixed(N_Vector v)
+{
+    return SUNDIALS_NVEC_CUSTOM;
+}
+
+static N_Vector N_VCloneEmpty_Fixed(N_Vector w)
+{
+    N_Vector v = N_VNewEmpty_Fixed();
+    if (v != NULL)
+    {
+        NF_DATA(v) = NULL;
+    }
+    return v;
+}
+
+static N_Vector N_VClone_Fixed(N_Vector w)
+{
+    return N_VNewEmpty_Fixed();
+}
+
+static void N_VSpace_Fixed(N_Vector v, long int* lrw, long int* liw)
+{
+    *lrw = NVECTOR_FIXED_LENGTH;
+    *liw = 1;
+}
+
+static realtype* N_VGetArrayPointer_Fixed(N_Vector v)
+{
+    return NF_DATA(v);
+}
+
+static void N_VSetArrayPointer_Fixed(realtype* data, N_Vector v)
+{
+    NF_DATA(v) = data;
+}
+
+static void N_VLinearSum_Fixed(realtype a, N_Vector x, realtype b, N_Vector y, N_Vector z)
+{
+    long int k;
+    NF_LOOP(k)
+    {
+        NF_DATA(z)[k] = a * NF_DATA(x)[k] + b * NF_DATA(y)[k];
+    }
+}
+
+static void N_VConst_Fixed(realtype c, N_Vector z)
+{
+    long int k;
+    NF_LOOP(k)
+    {
+        NF_DATA(z)[k] = c;
+    }
+}
+
+static void N_VProd_Fixed(N_Vector x, N_Vector y, N_Vector z)
+{
+    long int k;
+    NF_LOOP(k)
+    {
+        NF_DATA(z)[k] = NF_DATA(x)[k] * NF_DATA(y)[k];
+    }
+}
+
+static void N_VDiv_Fixed(N_Vector x, N_Vector y, N_Vector z)
+{
+    long int k;
+    NF_LOOP(k)
+    {
+        NF_DATA(z)[k] = NF_DATA(x)[k] / NF_DATA(y)[k];
+    }
+}
+
+static void N_VScale_Fixed(realtype c, N_Vector x, N_Vector z)
+{
+    long int k;
+    NF_LOOP(k)
+    {
+        NF_DATA(z)[k] = c * NF_DATA(x)[k];
+    }
+}
+
+static void N_VAbs_Fixed(N_Vector x, N_Vector z)
+{
+    long int k;
+    NF_LOOP(k)
+    {
+        NF_DATA(z)[k] = fabs(NF_DATA(x)[k]);
+    }
+}
+
+static void N_VInv_Fixed(N_Vector x, N_Vector z)
+{
+    long int k;
+    NF_LOOP(k)
+    {
+        NF_DATA(z)[k] = 1. / NF_DATA(x)[k];
+    }
+}
+
+static void N_VAddConst_Fixed(N_Vector x, realtype b, N_Vector z)
+{
+    long int k;
+    NF_LOOP(k)
+    {
+        NF_DATA(z)[k] = NF_DATA(x)[k] + b;
+    }
+}
+
+static realtype N_VDotProd_Fixed(N_Vector x, N_Vector y)
+{
+    realtype sum = 0.;
+    long int k;
+    NF_LOOP(k)
+    {
+        sum += NF_DATA(x)[k] * NF_DATA(y)[k];
+    }
+    return sum;
+}
+
+static realtype N_VMaxNorm_Fixed(N_Vector x)
+{
+    realtype max = 0.;
+    long int k;
+    NF_LOOP(k)
+    {
+        if (fabs(NF_DATA(x)[k]) > max)
+        {
+            max = fabs(NF_DATA(x)[k]);
+        }
+    }
+    return max;
+}
+
+static realtype N_VWrmsNorm_Fixed(N_Vector x, N_Vector w)
+{
+    realtype sum = 0.;
+    long int k;
+    NF_LOOP(k)
+    {
+        realtype product = NF_DATA(x)[k] * NF_DATA(w)[k];
+        sum += product * product;
+    }
+    return sqrt(sum / NVECTOR_FIXED_LENGTH);
+}
+
+static realtype N_VWrmsNormMask_Fixed(N_Vector x, N_Vector w, N_Vector id)
+{
+    realtype sum = 0.;
+    long int k;
+    NF_LOOP(k)
+    {
+        if (NF_DATA(id)[k] > 0.)
+        {
+            realtype product = NF_DATA(x)[k] * NF_DATA(w)[k];
+            sum += product * product;
+        }
+    }
+    return sqrt(sum / NVECTOR_FIXED_LENGTH);
+}
+
+static realtype N_VMin_Fixed(N_Vector x)
+{
+    realtype min = NF_DATA(x)[0];
+    long int k;
+    NF_LOOP(k)
+    {
+        if (NF_DATA(x)[k] < min)
+        {
+            min = NF_DATA(x)[k];
+        }
+    }
+    return min;
+}
+
+static realtype N_VWL2Norm_Fixed(N_Vector x, N_Vector w)
+{
+    realtype sum = 0.;
+    long int k;
+    NF_LOOP(k)
+    {
+        realtype product = NF_DATA(x)[k] * NF_DATA(w)[k];
+        sum += product * product;
+    }
+    return sqrt(sum);
+}
+
+static realtype N_VL1Norm_Fixed(N_Vector x)
+{
+    realtype sum = 0.;
+    long int k;
+    NF_LOOP(k)
+    {
+        sum += fabs(NF_DATA(x)[k]);
+    }
+    return sum;
+}
+
+static void N_VCompare_Fixed(realtype c, N_Vector x, N_Vector z)
+{
+    long int k;
+    NF_LOOP(k)
+    {
+        NF_DATA(z)[k] = fabs(NF_DATA(x)[k]) >= c ? 1. : 0.;
+    }
+}
+
+static booleantype N_VInvTest_Fixed(N_Vector x, N_Vector z)
+{
+    booleantype nonzero = TRUE;
+    long int k;
+    NF_LOOP(k)
+    {
+        if (NF_DATA(x)[k] == 0.)
+        {
+            nonzero = FALSE;
+        }
+        else
+        {
+            NF_DATA(z)[k] = 1. / NF_DATA(x)[k];
+        }
+    }
+    return nonzero;
+}
+
+static booleantype N_VConstrMask_Fixed(N_Vector c, N_Vector x, N_Vector m)
+{
+    booleantype satisfied = TRUE;
+    long int k;
+    NF_LOOP(k)
+    {
+        realtype constraint = NF_DATA(c)[k];
+        realtype product = NF_DATA(x)[k] * constraint;
+        NF_DATA(m)[k] = 0.;
+        if (constraint == 0.)
+        {
+            continue;
+        }
+        if ((fabs(constraint) > 1.5 && product <= 0.) || (fabs(constraint) > 0.5 && product < 0.))
+        {
+            satisfied = FALSE;
+            NF_DATA(m)[k] = 1.;
+        }
+    }
+    return satisfied;
+}
+
+static realtype N_VMinQuotient_Fixed(N_Vector num, N_Vector denom)
+{
+    realtype min = DBL_MAX;
+    long int k;
+    NF_LOOP(k)
+    {
+        if (NF_DATA(denom)[k] != 0. && NF_DATA(num)[k] / NF_DATA(denom)[k] < min)
+        {
+            min = NF_DATA(num)[k] / NF_DATA(denom)[k];
+        }
+    }
+    return min;
+}
+
+static struct _generic_N_Vector_Ops FixedVectorOps =
+{
+    .nvgetvectorid = N_VGetVectorID_Fixed,
+    .nvclone = N_VClone_Fixed,
+    .nvcloneempty = N_VCloneEmpty_Fixed,
+    .nvdestroy = N_VDestroy_Fixed,
+    .nvspace = N_VSpace_Fixed,
+    .nvgetarraypointer = N_VGetArrayPointer_Fixed,
+    .nvsetarraypointer = N_VSetArrayPointer_Fixed,
+    .nvlinearsum = N_VLinearSum_Fixed,
+    .nvconst = N_VConst_Fixed,
+    .nvprod = N_VProd_Fixed,
+    .nvdiv = N_VDiv_Fixed,
+    .nvscale = N_VScale_Fixed,
+    .nvabs = N_VAbs_Fixed,
+    .nvinv = N_VInv_Fixed,
+    .nvaddconst = N_VAddConst_Fixed,
+    .nvdotprod = N_VDotProd_Fixed,
+    .nvmaxnorm = N_VMaxNorm_Fixed,
+    .nvwrmsnorm = N_VWrmsNorm_Fixed,
+    .nvwrmsnormmask = N_VWrmsNormMask_Fixed,
+    .nvmin = N_VMin_Fixed,
+    .nvwl2norm = N_VWL2Norm_Fixed,
+    .nvl1norm = N_VL1Norm_Fixed,
+    .nvcompare = N_VCompare_Fixed,
+    .nvinvtest = N_VInvTest_Fixed,
+    .nvconstrmask = N_VConstrMask_Fixed,
+    .nvminquotient = N_VMinQuotient_Fixed
+};
+
+#endif
@@ -0,0 +1,118 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Slaven Glumac
+ *
+ * Binary configuration plan written by PackPlan. A plan holds a
+ * configuration with all names already resolved: the instances with their
+ * GUIDs and extracted libraries, the parameters as value references with
+ * parsed values and the connections grouped by their source instance.
+ * Instances may run at a multiple of the base communication step size.
+ * A master maps the file into memory and uses it in place.
+ *
+ * Layout, every part starts at a multiple of 8 bytes:
+ * struct PlanHeader
+ * struct PlanParameter[numberOfParameters]
+ * struct PlanInstance[numberOfInstances]
+ * struct PlanConnection[numberOfConnections]
+ * char strings[sizeOfStrings], zero terminated strings referenced by offset
+ */
+#ifndef PLAN_H
+#define PLAN_H
+
+#include <stdint.h>
+
+#define PLAN_MAGIC 0x4e414c50u /* "PLAN" */
+#define PLAN_VERSION 3u
+
+enum PlanType
+{
+    PlanReal = 0,
+    PlanInteger,
+    PlanBoolean,
+    PlanString
+};
+
+struct PlanHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t numberOfInstances;
+    uint32_t numberOfParameters;
+    uint32_t numberOfConnections;
+    uint32_t sizeOfStrings;
+    uint32_t reserved;
+};
+
+struct PlanParameter
+{
+    uint32_t instance;
+    uint32_t type;
+    uint32_t valueReference;
+    uint32_t reserved;
+    union
+    {
+        double real;
+        int32_t integer; /* Integer and Boolean */
+        uint32_t string; /* offset into strings */
+    } value;
+};
+
+enum PlanInstanceFlags
+{
+    /* Without inputs the outputs only depend on time and the parameters, so
+       they can be computed for the whole simulation ahead of time */
+    PlanSource = 1,
+    /* Has tunable parameters; a master recomputes the precomputed outputs of
+       a source from the time it sets one of them */
+    PlanTunable = 2
+};
+
+/* Strings are given as offsets into strings */
+struct PlanInstance
+{
+    uint32_t instanceName;
+    uint32_t guid;
+    uint32_t modelIdentifier;
+    uint32_t library;
+    uint32_t resources;
+    uint32_t firstParameter;
+    uint32_t numberOfParameters;
+    uint32_t firstConnection;
+    uint32_t numberOfConnections;
+    uint32_t stepRatio; /* communication step size in base step sizes, at least 1 */
+    uint32_t flags; /* PlanInstanceFlags */
+    uint32_t reserved;
+};
+
+/* Connections are sorted by their source instance */
+struct PlanConnection
+{
+    uint32_t type;
+    uint32_t source;
+    uint32_t sourceValueReference;
+    uint32_t destination;
+    uint32_t destinationValueReference;
+    uint32_t reserved;
+};
+
+#define PLAN_ALIGN(size) (((size) + 7u) & ~(uint32_t)7u)
+
+#define PLAN_HEADER(plan) ((const struct PlanHeader*)(plan))
+#define PLAN_PARAMETERS(plan) ((const struct PlanParameter*)((const char*)(plan) + \
+    sizeof(struct PlanHeader)))
+#define PLAN_INSTANCES(plan) ((const struct PlanInstance*)((const char*)PLAN_PARAMETERS(plan) + \
+    PLAN_HEADER(plan)->numberOfParameters * sizeof(struct PlanParameter)))
+#define PLAN_CONNECTIONS(plan) ((const struct PlanConnection*)((const char*)PLAN_INSTANCES(plan) + \
+    PLAN_HEADER(plan)->numberOfInstances * sizeof(struct PlanInstance)))
+#define PLAN_STRINGS(plan) ((const char*)PLAN_CONNECTIONS(plan) + \
+    PLAN_HEADER(plan)->numberOfConnections * sizeof(struct PlanConnection))
+#define PLAN_STRING(plan, offset) (PLAN_STRINGS(plan) + (offset))
+
+#define PLAN_SIZE(numberOfInstances, numberOfParameters, numberOfConnections, sizeOfStrings) \
+    (sizeof(struct PlanHeader) + (numberOfParameters) * sizeof(struct PlanParameter) + \
+    (numberOfInstances) * sizeof(struct PlanInstance) + \
+    (numberOfConnections) * sizeof(struct PlanConnection) + PLAN_ALIGN(sizeOfStrings))
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Slaven Glumac
+ *
+ * Binary recording of the FMI calls made to one instance, written by FMUs
+ * built with FMU_RECORD and read by Replay. The recording holds the values
+ * set, the input derivatives, the communication steps, the values got and
+ * the FMU states, so a single FMU can be driven exactly as in the coupled
+ * simulation. States are identified by their address in the recorded run.
+ *
+ * Layout, every record starts at a multiple of 8 bytes:
+ * struct RecordingHeader
+ * records until the end of the file, each a struct Record followed by
+ * RecordSetupExperiment            struct RecordExperiment
+ * RecordSetReal, RecordGetReal     double value[count], uint32_t vr[count]
+ * RecordSetInteger, SetBoolean     uint32_t vr[count], int32_t value[count]
+ * RecordSetRealInputDerivatives,
+ * RecordGetRealOutputDerivatives   double value[count], uint32_t vr[count],
+ *                                  int32_t order[count]
+ * RecordDoStep                     struct RecordStep
+ * RecordGetFMUstate, SetFMUstate,
+ * RecordFreeFMUstate               uint64_t state
+ * RecordDeSerializeFMUstate        uint64_t state, char serializedState[count]
+ * and padded to size bytes. The other records have no data.
+ */
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <stdint.h>
+
+#define RECORDING_MAGIC 0x52554d46u /* "FMUR" */
+#define RECORDING_VERSION 1u
+#define RECORDING_GUID_SIZE 40
+#define RECORDING_NAME_SIZE 256
+
+struct RecordingHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    char guid[RECORDING_GUID_SIZE];
+    char instanceName[RECORDING_NAME_SIZE]; /* truncated if longer */
+};
+
+enum RecordType
+{
+    RecordSetupExperiment = 1,
+    RecordEnterInitializationMode,
+    RecordExitInitializationMode,
+    RecordSetReal,
+    RecordSetInteger,
+    RecordSetBoolean,
+    RecordSetRealInputDerivatives,
+    RecordDoStep,
+    RecordGetReal,
+    RecordGetRealOutputDerivatives,
+    RecordTerminate,
+    RecordReset,
+    RecordGetFMUstate,
+    RecordSetFMUstate,
+    RecordFreeFMUstate,
+    RecordDeSerializeFMUstate
+};
+
+struct Record
+{
+    uint32_t type;
+    uint32_t count; /* number of value references or bytes */
+    uint32_t size; /* of the whole record in bytes */
+    uint32_t reserved;
+};
+
+struct RecordExperiment
+{
+    int32_t toleranceDefined;
+    int32_t stopTimeDefined;
+    double tolerance;
+    double startTime;
+    double stopTime;
+};
+
+struct RecordStep
+{
+    double currentCommunicationPoint;
+    double communicationStepSize;
+    int32_t noSetFMUStatePriorToCurrentPoint;
+    uint32_t reserved;
+};
+
+#define RECORD_ALIGN(size) (((size) + 7u) & ~(uint32_t)7u)
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2026 Slaven Glumac
+ *
+ * Status kinds beyond FMI 2.0 accepted by fmi2GetIntegerStatus and
+ * fmi2GetRealStatus of the FMUs built from template.h. They report counters
+ * which each instance keeps from fmi2Instantiate on. Integrator kinds are
+ * only available from models solved with CVODE, the others return
+ * fmi2Discard for them.
+ *
+ * The durations of fmi2DoStep are also kept as a histogram with bins of
+ * powers of two microseconds. StatisticsDoStepHistogram + k counts the steps
+ * which took from 2^(k-1) up to 2^k microseconds, bin 0 those under one
+ * microsecond and the last bin all longer ones.
+ *
+ * StatisticsStateDerivativeNorm is not a counter but the largest absolute
+ * derivative of the internal states at the current time with the current
+ * inputs. A master can use it to detect that an instance has settled.
+ */
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#define STATISTICS_HISTOGRAM_BINS 32
+
+enum StatisticsKind
+{
+    /* fmi2GetIntegerStatus */
+    StatisticsDoSteps = 1000,
+    StatisticsGetReals,
+    StatisticsSetReals,
+    StatisticsSetRealInputDerivatives,
+    StatisticsIntegratorSteps,
+    StatisticsRhsEvaluations,
+    StatisticsJacobianEvaluations,
+    StatisticsNewtonIterations,
+    StatisticsErrorTestFailures,
+    StatisticsDoStepHistogram = 1100,
+    /* fmi2GetRealStatus, in seconds */
+    StatisticsDoStepTime = 2000,
+    StatisticsDoStepLastTime,
+    StatisticsDoStepMinTime,
+    StatisticsDoStepMaxTime,
+    StatisticsStateDerivativeNorm
+};
+
+struct IntegratorStatistics
+{
+    long int steps;
+    long int rhsEvaluations;
+    long int jacobianEvaluations;
+    long int newtonIterations;
+    long int errorTestFailures;
+};
+
+#endif // STATISTICS_H
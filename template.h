@@ -8,7 +8,7 @@
  *
  * Code using this should define the following macros:
  * MAX_INPUT_DERIVATIVE_ORDER, NUMBER_OF_REALS, NUMBER_OF_INTEGERS,
- * NUMBER_OF_BOOLEANS, NUMBER_OF_STRINGS
+ * NUMBER_OF_BOOLEANS, NUMBER_OF_STRINGS, NUMBER_OF_INTERNAL_STATES
  * initalize the following mapping:
  * const fmi2ValueReference ivrs[]
  * and define the following struct:
@@ -20,11 +20,108 @@
  * void StartInitialization(fmi2Component component);
  * fmi2Status FinishInitialization(fmi2Component component);
  * fmi2Status StateUpdate(fmi2Component component, fmi2Real communicationStepSize);
+ * void SaveInternal(fmi2Component component, fmi2Real state[]);
+ * fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[]);
+ *
+ * SaveInternal and RestoreInternal copy the NUMBER_OF_INTERNAL_STATES reals
+ * which, together with the variables, describe the state of struct Internal.
+ * They are used by fmi2GetFMUstate and fmi2SetFMUstate.
+ *
+ * Models which provide output derivatives define MAX_OUTPUT_DERIVATIVE_ORDER
+ * and the function:
+ * fmi2Status OutputDerivative(fmi2Component component, fmi2ValueReference vr, fmi2Integer order, fmi2Real* value);
+ *
+ * Models with known discontinuities define HAS_TIME_EVENTS and the function:
+ * fmi2Boolean NextEventTime(fmi2Component component, fmi2Real* time);
+ *
+ * Models solved with an integrator define HAS_INTEGRATOR_STATISTICS and:
+ * fmi2Status IntegratorStatistics(fmi2Component component, struct IntegratorStatistics* statistics);
+ *
+ * Models with internal states define HAS_STATE_DERIVATIVE_NORM and return
+ * the largest absolute state derivative at the current time and inputs:
+ * fmi2Status StateDerivativeNorm(fmi2Component component, fmi2Real* norm);
+ * Models without internal states report 0.
+ *
+ * Every instance is a single allocation holding the variables, struct
+ * Internal and the instance name. With FMU_POOL_SIZE > 0 freed instances
+ * are kept in a pool of up to FMU_POOL_SIZE per library and reused by
+ * fmi2Instantiate with the same memory callbacks.
+ *
+ * With logging on, log and logf store binary records with the raw argument
+ * values, the time and the category in a buffer of FMU_LOG_CAPACITY (1024 by
+ * default) records per instance. The records are formatted and passed to the
+ * logger in batches at the end of fmi2ExitInitializationMode and fmi2DoStep,
+ * on errors, when the buffer is full and when the instance terminates. A
+ * capacity of 0 passes every message on directly. Only the format pointer is
+ * stored, so the message of log and logf has to be a string literal.
+ *
+ * When FMU_TRACE is defined every instance records the entry points in the
+ * Chrome trace format to <instanceName>.trace.json in the directory given
+ * by the environment variable FMU_TRACE_DIRECTORY or the working directory.
+ *
+ * When FMU_RECORD is defined every instance, or only the one named by the
+ * environment variable FMU_RECORD_INSTANCE, records the FMI calls it gets
+ * as described in recording.h to <instanceName>.record in the directory
+ * given by FMU_RECORD_DIRECTORY or the working directory. Replay drives the
+ * FMU again from the recording.
  */
 #ifndef TEMPLATE_H
 #define TEMPLATE_H
 #include <fmi2Functions.h>
 #include <string.h>
+#include <stdarg.h>
+#include <time.h>
+#include <statistics.h>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+#ifdef FMU_TRACE
+#include <stdlib.h>
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+#endif
+#ifdef FMU_RECORD
+#include <stdlib.h>
+#include <recording.h>
+#endif
+
+/*
+ * Pooling is off by default. A pooled instance is not returned to the
+ * importer by fmi2FreeInstance, as FMI 2.0 requires, but only when it is
+ * reused or when the library is unloaded. Enable it only for importers
+ * whose freeMemory stays valid until the library is unloaded.
+ */
+#ifndef FMU_POOL_SIZE
+#define FMU_POOL_SIZE 0
+#endif
+
+#ifndef FMU_LOG_CAPACITY
+#define FMU_LOG_CAPACITY 1024
+#endif
+
+#ifndef MAX_OUTPUT_DERIVATIVE_ORDER
+#define MAX_OUTPUT_DERIVATIVE_ORDER 0
+#endif
+
+#ifndef HAS_TIME_EVENTS
+#define HAS_TIME_EVENTS 0
+#endif
+
+#ifndef HAS_INTEGRATOR_STATISTICS
+#define HAS_INTEGRATOR_STATISTICS 0
+#endif
+
+#ifndef HAS_STATE_DERIVATIVE_NORM
+#define HAS_STATE_DERIVATIVE_NORM 0
+#endif
 
 #define _this ((struct Component*)component)
 
@@ -35,8 +132,21 @@
 
 #define _t _this->time
 #define _tolerance _this->tolerance
+#define _toleranceDefined _this->toleranceDefined
 #define _internal (_this->internal)
 #include <stdio.h>
+#if FMU_LOG_CAPACITY > 0
+#define log(status, message)\
+    if (_this->loggingOn) \
+    { \
+        LogPush(component, status, "" message); \
+    }
+#define logf(status, message, ...)\
+    if (_this->loggingOn) \
+    { \
+        LogPush(component, status, "" message, ##__VA_ARGS__); \
+    }
+#else
 #define log(status, message)\
     if (_this->loggingOn) \
     { \
@@ -44,8 +154,8 @@
             ( _this->callbacks->componentEnvironment \
             , _this->instanceName \
             , status \
-            , "logAll" \
-            , message); \
+            , LogCategory(status) \
+            , "" message); \
     }
 #define logf(status, message, ...)\
     if (_this->loggingOn) \
@@ -54,9 +164,10 @@
             ( _this->callbacks->componentEnvironment \
             , _this->instanceName \
             , status \
-            , "logAll" \
-            , message, ##__VA_ARGS__); \
+            , LogCategory(status) \
+            , "" message, ##__VA_ARGS__); \
     }
+#endif
 
 void InstantiateInternal(fmi2Component component);
 void FreeInternal(fmi2Component component);
@@ -64,23 +175,209 @@ void StartInitialization(fmi2Component component);
 fmi2Status FinishInitialization(fmi2Component component);
 fmi2Status StateUpdate(fmi2Component component, fmi2Real communicationStepSize);
 fmi2Status OutputUpdate(fmi2Component component);
+void SaveInternal(fmi2Component component, fmi2Real state[]);
+fmi2Status RestoreInternal(fmi2Component component, const fmi2Real state[]);
+#if MAX_OUTPUT_DERIVATIVE_ORDER > 0
+fmi2Status OutputDerivative(fmi2Component component, fmi2ValueReference vr, fmi2Integer order, fmi2Real* value);
+#endif
+#if HAS_TIME_EVENTS
+fmi2Boolean NextEventTime(fmi2Component component, fmi2Real* time);
+#endif
+#if HAS_INTEGRATOR_STATISTICS
+fmi2Status IntegratorStatistics(fmi2Component component, struct IntegratorStatistics* statistics);
+#endif
+#if HAS_STATE_DERIVATIVE_NORM
+fmi2Status StateDerivativeNorm(fmi2Component component, fmi2Real* norm);
+#endif
+
+struct Statistics
+{
+    long int doSteps;
+    long int getReals;
+    long int setReals;
+    long int setRealInputDerivatives;
+    fmi2Real doStepTime;
+    fmi2Real doStepLastTime;
+    fmi2Real doStepMinTime;
+    fmi2Real doStepMaxTime;
+    long int doStepHistogram[STATISTICS_HISTOGRAM_BINS];
+    fmi2Status doStepStatus;
+};
+
+#if FMU_LOG_CAPACITY > 0
+#define LOG_ARGUMENTS 12
+#define LOG_SPECIFICATION 16
+#define LOG_TEXT 1024
+
+enum LogType
+{
+    LogPercent,
+    LogInt,
+    LogLong,
+    LogSize,
+    LogDouble,
+    LogUnsupported
+};
+
+/* A message before formatting, message is the literal format given to log or logf */
+struct LogRecord
+{
+    fmi2Status status;
+    unsigned int numberOfArguments;
+    fmi2Real time;
+    fmi2String category;
+    fmi2String message;
+    union
+    {
+        long integer;
+        size_t size;
+        double real;
+    } arguments[LOG_ARGUMENTS];
+};
+
+struct Log
+{
+    struct LogRecord* records;
+    size_t count;
+};
+#endif
+
+#ifdef FMU_TRACE
+#define TRACE_CAPACITY 4096
+#define TRACE_BEGIN(name) TraceRecord(component, name, 'B')
+#define TRACE_END(name) TraceRecord(component, name, 'E')
+
+struct TraceEvent
+{
+    const char* name;
+    char phase;
+    fmi2Real time;
+    unsigned long thread;
+};
+
+struct Trace
+{
+    FILE* file;
+    fmi2Boolean empty;
+    size_t count;
+    struct TraceEvent* events;
+};
+#else
+#define TRACE_BEGIN(name)
+#define TRACE_END(name)
+#endif
+
+#ifdef FMU_RECORD
+#define RECORD(type, nvr, data, size, reals, vr, integers) \
+    RecordWrite(component, type, nvr, data, size, reals, vr, integers)
+#define RECORD_STATE(type, state) \
+    { \
+        uint64_t recordedState = (uint64_t)(uintptr_t)(state); \
+        RECORD(type, 0, &recordedState, sizeof(recordedState), NULL, NULL, NULL); \
+    }
+#else
+#define RECORD(type, nvr, data, size, reals, vr, integers)
+#define RECORD_STATE(type, state)
+#endif
+
+/* Kinds without variables keep one unused element */
+#define ARRAY_SIZE(n) ((n) > 0 ? (n) : 1)
+
+/* Room for a GUID in braces with the terminating zero */
+#define GUID_SIZE 40
 
 struct Component
 {
-    fmi2Real** reals;
-    fmi2Integer* integers;
-    fmi2Boolean* booleans;
-    fmi2String* strings;
-    fmi2Char* instanceName;
+    fmi2Real reals[ARRAY_SIZE(NUMBER_OF_REALS)][MAX_INPUT_DERIVATIVE_ORDER + 1];
+    fmi2Integer integers[ARRAY_SIZE(NUMBER_OF_INTEGERS)];
+    fmi2Boolean booleans[ARRAY_SIZE(NUMBER_OF_BOOLEANS)];
+    fmi2String strings[ARRAY_SIZE(NUMBER_OF_STRINGS)];
     fmi2Real time;
     fmi2Real startTime;
     fmi2Real stopTime;
     fmi2Real tolerance;
+    fmi2Boolean toleranceDefined;
     fmi2Boolean loggingOn;
     const fmi2CallbackFunctions* callbacks;
+    fmi2Char guid[GUID_SIZE];
+    struct Statistics statistics;
+#if FMU_LOG_CAPACITY > 0
+    struct Log logBuffer;
+#endif
+#ifdef FMU_TRACE
+    struct Trace trace;
+#endif
+#ifdef FMU_RECORD
+    FILE* recording;
+#endif
     struct Internal internal;
+    /* Allocation and the pool */
+    size_t size;
+    fmi2CallbackAllocateMemory allocateMemory;
+    fmi2CallbackFreeMemory freeMemory;
+    struct Component* next;
+    fmi2Char instanceName[];
+};
+
+/*
+ * Snapshot of a component used as fmi2FMUstate. The header is followed by
+ * the reals with their derivatives, the internal states, the integers and
+ * the booleans. Strings are not part of the state.
+ *
+ * Serialized states may be kept on disk, so the header carries a magic
+ * number, the version of this layout and the GUID of the model. A state of
+ * another model, layout or byte order is rejected.
+ */
+#define STATE_MAGIC 0x53554d46u /* "FMUS" */
+#define STATE_VERSION 1u
+
+struct State
+{
+    unsigned int magic;
+    unsigned int version;
+    size_t size;
+    size_t numberOfInternalStates;
+    fmi2Real time;
+    fmi2Char guid[GUID_SIZE];
 };
 
+#define STATE_REALS(state) ((fmi2Real*)((struct State*)(state) + 1))
+#define STATE_INTERNAL(state) (STATE_REALS(state) + NUMBER_OF_REALS * (MAX_INPUT_DERIVATIVE_ORDER + 1))
+#define STATE_INTEGERS(state) ((fmi2Integer*)(STATE_INTERNAL(state) + (state)->numberOfInternalStates))
+#define STATE_BOOLEANS(state) ((fmi2Boolean*)(STATE_INTEGERS(state) + NUMBER_OF_INTEGERS))
+
+size_t StateSize(size_t numberOfInternalStates)
+{
+    return sizeof(struct State)
+        + (NUMBER_OF_REALS * (MAX_INPUT_DERIVATIVE_ORDER + 1) + numberOfInternalStates) * sizeof(fmi2Real)
+        + NUMBER_OF_INTEGERS * sizeof(fmi2Integer)
+        + NUMBER_OF_BOOLEANS * sizeof(fmi2Boolean);
+}
+
+fmi2Boolean StateBelongs(fmi2Component component, const struct State* state)
+{
+    return state->magic == STATE_MAGIC && state->version == STATE_VERSION
+        && strncmp(state->guid, _this->guid, GUID_SIZE) == 0;
+}
+
+#ifdef BLOCKS_H
+/* Evaluates a function of blocks.h on the reals of the instance */
+void BlockEvaluate(fmi2Component component, BlockFunction function, fmi2Real h)
+{
+    double reals[NUMBER_OF_REALS];
+    fmi2ValueReference vr;
+    for (vr = 0; vr < NUMBER_OF_REALS; vr++)
+    {
+        reals[vr] = r(vr,0);
+    }
+    function(reals, _t, h);
+    for (vr = 0; vr < NUMBER_OF_REALS; vr++)
+    {
+        r(vr,0) = reals[vr];
+    }
+}
+#endif
+
 fmi2Real interp(fmi2Component component, fmi2ValueReference vr, fmi2Real dt)
 {
     fmi2Real u = r(vr,0);
@@ -99,6 +396,425 @@ fmi2Real interp(fmi2Component component, fmi2ValueReference vr, fmi2Real dt)
     return u;
 }
 
+fmi2Real Now(void)
+{
+    struct timespec now;
+#ifdef _WIN32
+    timespec_get(&now, TIME_UTC);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &now);
+#endif
+    return now.tv_sec + 1e-9 * now.tv_nsec;
+}
+
+/* The category of a message is given by its status as in the FMI standard */
+static fmi2String LogCategory(fmi2Status status)
+{
+    switch (status)
+    {
+    case fmi2Warning:
+        return "logStatusWarning";
+    case fmi2Discard:
+        return "logStatusDiscard";
+    case fmi2Error:
+        return "logStatusError";
+    case fmi2Fatal:
+        return "logStatusFatal";
+    case fmi2Pending:
+        return "logStatusPending";
+    default:
+        return "logAll";
+    }
+}
+
+#if FMU_LOG_CAPACITY > 0
+/* Copies the conversion starting at format into specification and returns what follows it */
+const char* LogNext(const char* format, char specification[], enum LogType* type)
+{
+    const char* start = format++;
+    size_t length;
+    int modifier = 0;
+    format += strspn(format, "-+ #0");
+    format += strspn(format, "0123456789");
+    if (*format == '.')
+    {
+        format++;
+        format += strspn(format, "0123456789");
+    }
+    if (*format == 'h' || *format == 'l' || *format == 'z')
+    {
+        modifier = *format++;
+    }
+    switch (*format)
+    {
+    case '%':
+        *type = format == start + 1 ? LogPercent : LogUnsupported;
+        break;
+    case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+        *type = modifier == 'l' ? LogLong : modifier == 'z' ? LogSize : LogInt;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        *type = modifier == 'z' ? LogUnsupported : LogDouble;
+        break;
+    default:
+        *type = LogUnsupported;
+        return format;
+    }
+    format++;
+    length = (size_t)(format - start);
+    if (length >= LOG_SPECIFICATION)
+    {
+        *type = LogUnsupported;
+        return format;
+    }
+    memcpy(specification, start, length);
+    specification[length] = '\0';
+    return format;
+}
+
+void LogDeliver(fmi2Component component, const struct LogRecord* record, const char* text)
+{
+    _this->callbacks->logger
+        ( _this->callbacks->componentEnvironment
+        , _this->instanceName
+        , record->status
+        , record->category
+        , "t = %g: %s"
+        , record->time
+        , text);
+}
+
+/* Formats the stored records and passes them to the logger */
+void LogFlush(fmi2Component component)
+{
+    struct Log* buffer = &_this->logBuffer;
+    char text[LOG_TEXT];
+    char specification[LOG_SPECIFICATION];
+    size_t k;
+    for (k = 0; k < buffer->count; k++)
+    {
+        const struct LogRecord* record = &buffer->records[k];
+        const char* format = record->message;
+        unsigned int argument = 0;
+        size_t n = 0;
+        while (*format != '\0' && n < LOG_TEXT - 1)
+        {
+            enum LogType type;
+            int written = 0;
+            if (*format != '%')
+            {
+                text[n++] = *format++;
+                continue;
+            }
+            format = LogNext(format, specification, &type);
+            switch (type)
+            {
+            case LogPercent:
+                text[n++] = '%';
+                break;
+            case LogInt:
+                written = snprintf(text + n, LOG_TEXT - n, specification, (int)record->arguments[argument++].integer);
+                break;
+            case LogLong:
+                written = snprintf(text + n, LOG_TEXT - n, specification, record->arguments[argument++].integer);
+                break;
+            case LogSize:
+                written = snprintf(text + n, LOG_TEXT - n, specification, record->arguments[argument++].size);
+                break;
+            case LogDouble:
+                written = snprintf(text + n, LOG_TEXT - n, specification, record->arguments[argument++].real);
+                break;
+            default:
+                break;
+            }
+            if (written > 0)
+            {
+                n += (size_t)written < LOG_TEXT - n ? (size_t)written : LOG_TEXT - 1 - n;
+            }
+        }
+        text[n] = '\0';
+        LogDeliver(component, record, text);
+    }
+    buffer->count = 0;
+}
+
+/* Stores a message, messages with conversions which are not stored are passed on directly */
+void LogPush(fmi2Component component, fmi2Status status, fmi2String message, ...)
+{
+    struct Log* buffer = &_this->logBuffer;
+    struct LogRecord* record;
+    const char* format = message;
+    char specification[LOG_SPECIFICATION];
+    enum LogType type;
+    va_list arguments;
+    if (buffer->records != NULL && buffer->count == FMU_LOG_CAPACITY)
+    {
+        LogFlush(component);
+    }
+    record = buffer->records == NULL ? NULL : &buffer->records[buffer->count];
+    if (record != NULL)
+    {
+        record->numberOfArguments = 0;
+    }
+    va_start(arguments, message);
+    while (record != NULL && (format = strchr(format, '%')) != NULL)
+    {
+        format = LogNext(format, specification, &type);
+        if (type == LogPercent)
+        {
+            continue;
+        }
+        if (type == LogUnsupported || record->numberOfArguments == LOG_ARGUMENTS)
+        {
+            record = NULL;
+            break;
+        }
+        switch (type)
+        {
+        case LogInt:
+            record->arguments[record->numberOfArguments].integer = va_arg(arguments, int);
+            break;
+        case LogLong:
+            record->arguments[record->numberOfArguments].integer = va_arg(arguments, long);
+            break;
+        case LogSize:
+            record->arguments[record->numberOfArguments].size = va_arg(arguments, size_t);
+            break;
+        default:
+            record->arguments[record->numberOfArguments].real = va_arg(arguments, double);
+            break;
+        }
+        record->numberOfArguments++;
+    }
+    va_end(arguments);
+    if (record == NULL)
+    {
+        struct LogRecord direct;
+        char text[LOG_TEXT];
+        LogFlush(component);
+        direct.status = status;
+        direct.time = _t;
+        direct.category = LogCategory(status);
+        va_start(arguments, message);
+        vsnprintf(text, sizeof(text), message, arguments);
+        va_end(arguments);
+        LogDeliver(component, &direct, text);
+        return;
+    }
+    record->status = status;
+    record->time = _t;
+    record->category = LogCategory(status);
+    record->message = message;
+    buffer->count++;
+    if (status != fmi2OK)
+    {
+        LogFlush(component);
+    }
+}
+
+void LogOpen(fmi2Component component)
+{
+    if (_this->logBuffer.records == NULL)
+    {
+        _this->logBuffer.records = _this->callbacks->allocateMemory(FMU_LOG_CAPACITY, sizeof(struct LogRecord));
+        _this->logBuffer.count = 0;
+    }
+}
+
+void LogClose(fmi2Component component)
+{
+    if (_this->logBuffer.records != NULL)
+    {
+        LogFlush(component);
+        _this->callbacks->freeMemory(_this->logBuffer.records);
+        _this->logBuffer.records = NULL;
+    }
+}
+#endif
+
+#ifdef FMU_TRACE
+void TraceOpen(fmi2Component component)
+{
+    const char* directory = getenv("FMU_TRACE_DIRECTORY");
+    char* path;
+    if (directory == NULL)
+    {
+        directory = ".";
+    }
+    path = _this->callbacks->allocateMemory(strlen(directory) + strlen(_this->instanceName) + 13, sizeof(char));
+    sprintf(path, "%s/%s.trace.json", directory, _this->instanceName);
+    _this->trace.file = fopen(path, "w");
+    _this->callbacks->freeMemory(path);
+    _this->trace.events = _this->callbacks->allocateMemory(TRACE_CAPACITY, sizeof(struct TraceEvent));
+    _this->trace.empty = fmi2True;
+    _this->trace.count = 0;
+    if (_this->trace.file != NULL)
+    {
+        fputs("[", _this->trace.file);
+    }
+}
+
+void TraceFlush(fmi2Component component)
+{
+    size_t i;
+    struct TraceEvent* event;
+    if (_this->trace.file != NULL)
+    {
+        for (i = 0; i < _this->trace.count; i++)
+        {
+            event = &_this->trace.events[i];
+            fprintf(_this->trace.file
+                , "%s\n{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": %d, \"tid\": %lu}"
+                , _this->trace.empty ? "" : ","
+                , event->name
+                , _this->instanceName
+                , event->phase
+                , 1e6 * event->time
+                , (int)getpid()
+                , event->thread);
+            _this->trace.empty = fmi2False;
+        }
+    }
+    _this->trace.count = 0;
+}
+
+void TraceRecord(fmi2Component component, const char* name, char phase)
+{
+    struct TraceEvent* event;
+    if (_this->trace.count == TRACE_CAPACITY)
+    {
+        TraceFlush(component);
+    }
+    event = &_this->trace.events[_this->trace.count++];
+    event->name = name;
+    event->phase = phase;
+    event->time = Now();
+#ifdef _WIN32
+    event->thread = 0;
+#else
+    event->thread = (unsigned long)pthread_self();
+#endif
+}
+
+void TraceClose(fmi2Component component)
+{
+    TraceFlush(component);
+    if (_this->trace.file != NULL)
+    {
+        fputs("\n]\n", _this->trace.file);
+        fclose(_this->trace.file);
+    }
+    _this->callbacks->freeMemory(_this->trace.events);
+}
+#endif
+
+#ifdef FMU_RECORD
+void RecordOpen(fmi2Component component)
+{
+    const char* directory = getenv("FMU_RECORD_DIRECTORY");
+    const char* instance = getenv("FMU_RECORD_INSTANCE");
+    struct RecordingHeader header;
+    char* path;
+    _this->recording = NULL;
+    if (instance != NULL && strcmp(instance, _this->instanceName) != 0)
+    {
+        return;
+    }
+    if (directory == NULL)
+    {
+        directory = ".";
+    }
+    path = _this->callbacks->allocateMemory(strlen(directory) + strlen(_this->instanceName) + 9, sizeof(char));
+    sprintf(path, "%s/%s.record", directory, _this->instanceName);
+    _this->recording = fopen(path, "wb");
+    _this->callbacks->freeMemory(path);
+    if (_this->recording == NULL)
+    {
+        return;
+    }
+    memset(&header, 0, sizeof(header));
+    header.magic = RECORDING_MAGIC;
+    header.version = RECORDING_VERSION;
+    memcpy(header.guid, _this->guid, sizeof(header.guid));
+    strncpy(header.instanceName, _this->instanceName, RECORDING_NAME_SIZE - 1);
+    fwrite(&header, sizeof(header), 1, _this->recording);
+}
+
+/* Writes a record with the fixed data followed by the arrays which are given */
+void RecordWrite
+    ( fmi2Component component
+    , enum RecordType type
+    , size_t nvr
+    , const void* data
+    , size_t size
+    , const fmi2Real reals[]
+    , const fmi2ValueReference vr[]
+    , const fmi2Integer integers[])
+{
+    static const char padding[8] = {0};
+    struct Record record;
+    size_t payload = size;
+    if (_this->recording == NULL)
+    {
+        return;
+    }
+    payload += reals != NULL ? nvr * sizeof(double) : 0;
+    payload += vr != NULL ? nvr * sizeof(uint32_t) : 0;
+    payload += integers != NULL ? nvr * sizeof(int32_t) : 0;
+    record.type = type;
+    record.count = (uint32_t)nvr;
+    record.size = RECORD_ALIGN((uint32_t)(sizeof(record) + payload));
+    record.reserved = 0;
+    fwrite(&record, sizeof(record), 1, _this->recording);
+    if (data != NULL)
+    {
+        fwrite(data, 1, size, _this->recording);
+    }
+    if (reals != NULL)
+    {
+        fwrite(reals, sizeof(double), nvr, _this->recording);
+    }
+    if (vr != NULL)
+    {
+        fwrite(vr, sizeof(uint32_t), nvr, _this->recording);
+    }
+    if (integers != NULL)
+    {
+        fwrite(integers, sizeof(int32_t), nvr, _this->recording);
+    }
+    fwrite(padding, 1, record.size - sizeof(record) - payload, _this->recording);
+}
+
+/* The state is followed by its serialization, which the replay deserializes again */
+void RecordDeSerialize(fmi2Component component, fmi2FMUstate state, const fmi2Byte serializedState[], size_t size)
+{
+    static const char padding[8] = {0};
+    uint64_t recordedState = (uint64_t)(uintptr_t)state;
+    struct Record record;
+    if (_this->recording == NULL)
+    {
+        return;
+    }
+    record.type = RecordDeSerializeFMUstate;
+    record.count = (uint32_t)size;
+    record.size = RECORD_ALIGN((uint32_t)(sizeof(record) + sizeof(recordedState) + size));
+    record.reserved = 0;
+    fwrite(&record, sizeof(record), 1, _this->recording);
+    fwrite(&recordedState, sizeof(recordedState), 1, _this->recording);
+    fwrite(serializedState, 1, size, _this->recording);
+    fwrite(padding, 1, record.size - sizeof(record) - sizeof(recordedState) - size, _this->recording);
+}
+
+void RecordClose(fmi2Component component)
+{
+    if (_this->recording != NULL)
+    {
+        fclose(_this->recording);
+        _this->recording = NULL;
+    }
+}
+#endif
+
 const char* fmi2GetTypesPlatform(void)
 {
     return fmi2TypesPlatform;
@@ -120,6 +836,16 @@ fmi2Status fmi2SetDebugLogging
     {
         return fmi2Fatal;
     }
+#if FMU_LOG_CAPACITY > 0
+    if (loggingOn)
+    {
+        LogOpen(c);
+    }
+    else
+    {
+        LogFlush(c);
+    }
+#endif
     c->loggingOn = loggingOn;
     return fmi2OK;
 }
@@ -131,19 +857,150 @@ fmi2Status fmi2Terminate(fmi2Component component)
         return fmi2Fatal;
     }
     log(fmi2OK, "fmi2Terminate");
+    RECORD(RecordTerminate, 0, NULL, 0, NULL, NULL, NULL);
+    logf(fmi2OK, "doSteps = %ld, getReals = %ld, setReals = %ld, setRealInputDerivatives = %ld, doStepTime = %lf, doStepMinTime = %lf, doStepMaxTime = %lf"
+        , _this->statistics.doSteps
+        , _this->statistics.getReals
+        , _this->statistics.setReals
+        , _this->statistics.setRealInputDerivatives
+        , _this->statistics.doStepTime
+        , _this->statistics.doStepMinTime
+        , _this->statistics.doStepMaxTime);
+#if HAS_INTEGRATOR_STATISTICS
+    {
+        struct IntegratorStatistics integrator;
+        if (IntegratorStatistics(component, &integrator) == fmi2OK)
+        {
+            logf(fmi2OK, "steps = %ld, rhsEvaluations = %ld, jacobianEvaluations = %ld, newtonIterations = %ld, errorTestFailures = %ld"
+                , integrator.steps
+                , integrator.rhsEvaluations
+                , integrator.jacobianEvaluations
+                , integrator.newtonIterations
+                , integrator.errorTestFailures);
+        }
+    }
+#endif
+#if FMU_LOG_CAPACITY > 0
+    LogFlush(component);
+#endif
     return fmi2OK;
 }
 
 fmi2Status fmi2Reset(fmi2Component component)
 {
+    struct Component* c = component;
     if (component == NULL)
     {
         return fmi2Fatal;
     }
     log(fmi2OK, "fmi2Reset");
+    RECORD(RecordReset, 0, NULL, 0, NULL, NULL, NULL);
+    /* Back to the state right after fmi2Instantiate, reusing the memory */
+    FreeInternal(c);
+    memset(c->reals, 0, sizeof(c->reals));
+    memset(c->integers, 0, sizeof(c->integers));
+    memset(c->booleans, 0, sizeof(c->booleans));
+    memset(c->strings, 0, sizeof(c->strings));
+    c->time = 0;
+    c->startTime = 0;
+    c->stopTime = 0;
+    c->tolerance = 0;
+    c->toleranceDefined = fmi2False;
+    memset(&c->statistics, 0, sizeof(c->statistics));
+    InstantiateInternal(c);
     return fmi2OK;
 }
 
+#if FMU_POOL_SIZE > 0
+static struct
+{
+    struct Component* first;
+    size_t count;
+#ifdef _WIN32
+    SRWLOCK lock;
+#else
+    pthread_mutex_t lock;
+#endif
+} pool =
+#ifdef _WIN32
+    {NULL, 0, SRWLOCK_INIT};
+#define PoolLock() AcquireSRWLockExclusive(&pool.lock)
+#define PoolUnlock() ReleaseSRWLockExclusive(&pool.lock)
+#else
+    {NULL, 0, PTHREAD_MUTEX_INITIALIZER};
+#define PoolLock() pthread_mutex_lock(&pool.lock)
+#define PoolUnlock() pthread_mutex_unlock(&pool.lock)
+#endif
+
+/* Takes a pooled instance of at least size bytes allocated by the callbacks */
+struct Component* PoolTake(const fmi2CallbackFunctions* callbacks, size_t size)
+{
+    struct Component** link;
+    struct Component* c = NULL;
+    PoolLock();
+    for (link = &pool.first; *link != NULL; link = &(*link)->next)
+    {
+        if ((*link)->size >= size
+            && (*link)->allocateMemory == callbacks->allocateMemory
+            && (*link)->freeMemory == callbacks->freeMemory)
+        {
+            c = *link;
+            *link = c->next;
+            pool.count--;
+            break;
+        }
+    }
+    PoolUnlock();
+    return c;
+}
+
+fmi2Boolean PoolPut(struct Component* c)
+{
+    fmi2Boolean put = fmi2False;
+    PoolLock();
+    if (pool.count < FMU_POOL_SIZE)
+    {
+        c->next = pool.first;
+        pool.first = c;
+        pool.count++;
+        put = fmi2True;
+    }
+    PoolUnlock();
+    return put;
+}
+
+/* Returns the pooled instances to the importers which allocated them */
+static void PoolDrain(void)
+{
+    struct Component* c;
+    PoolLock();
+    while ((c = pool.first) != NULL)
+    {
+        pool.first = c->next;
+        c->freeMemory(c);
+    }
+    pool.count = 0;
+    PoolUnlock();
+}
+
+#ifdef _WIN32
+BOOL WINAPI DllMain(HINSTANCE instance, DWORD reason, LPVOID reserved)
+{
+    /* On process termination the importer's allocator may be gone already */
+    if (reason == DLL_PROCESS_DETACH && reserved == NULL)
+    {
+        PoolDrain();
+    }
+    return TRUE;
+}
+#else
+__attribute__((destructor)) static void PoolUnload(void)
+{
+    PoolDrain();
+}
+#endif
+#endif
+
 fmi2Component fmi2Instantiate
     ( fmi2String instanceName
     , fmi2Type fmuType
@@ -153,23 +1010,33 @@ fmi2Component fmi2Instantiate
     , fmi2Boolean visible
     , fmi2Boolean loggingOn)
 {
-    struct Component* c = callbacks->allocateMemory(1, sizeof(struct Component));
-    size_t i, j;
-    c->reals = callbacks->allocateMemory(NUMBER_OF_REALS, sizeof(fmi2Real*));
-    for (i = 0; i < NUMBER_OF_REALS; i++)
+    size_t size = sizeof(struct Component) + strlen(instanceName) + 1;
+    struct Component* c = NULL;
+#if FMU_POOL_SIZE > 0
+    c = PoolTake(callbacks, size);
+    if (c != NULL)
     {
-        c->reals[i] = callbacks->allocateMemory(MAX_INPUT_DERIVATIVE_ORDER+1, sizeof(fmi2Real));
-        for (j = 0; j <= MAX_INPUT_DERIVATIVE_ORDER; j++)
+        size = c->size;
+        memset(c, 0, size);
+    }
+#endif
+    if (c == NULL)
+    {
+        c = callbacks->allocateMemory(1, size);
+        if (c == NULL)
         {
-            c->reals[i][j] = 0;
+            return NULL;
         }
     }
-    c->integers = callbacks->allocateMemory(NUMBER_OF_INTEGERS, sizeof(fmi2Real));
-    c->booleans = callbacks->allocateMemory(NUMBER_OF_BOOLEANS, sizeof(fmi2Real));
-    c->strings = callbacks->allocateMemory(NUMBER_OF_STRINGS, sizeof(fmi2Real));
+    c->size = size;
+    c->allocateMemory = callbacks->allocateMemory;
+    c->freeMemory = callbacks->freeMemory;
     c->callbacks = callbacks;
-    c->instanceName = callbacks->allocateMemory(1 + strlen(instanceName), sizeof(fmi2Char));
     strcpy(c->instanceName, instanceName);
+    if (fmuGUID != NULL)
+    {
+        strncpy(c->guid, fmuGUID, GUID_SIZE - 1);
+    }
     if (callbacks->logger == NULL)
     {
         c->loggingOn = fmi2False;
@@ -178,6 +1045,18 @@ fmi2Component fmi2Instantiate
     {
         c->loggingOn = loggingOn;
     }
+#if FMU_LOG_CAPACITY > 0
+    if (c->loggingOn)
+    {
+        LogOpen(c);
+    }
+#endif
+#ifdef FMU_TRACE
+    TraceOpen(c);
+#endif
+#ifdef FMU_RECORD
+    RecordOpen(c);
+#endif
     InstantiateInternal(c);
     return c;
 }
@@ -185,22 +1064,27 @@ fmi2Component fmi2Instantiate
 void fmi2FreeInstance(fmi2Component component)
 {
     struct Component* c = component;
-    size_t i;
     if (component == NULL)
     {
         return;
     }
+#ifdef FMU_TRACE
+    TraceClose(c);
+#endif
+#ifdef FMU_RECORD
+    RecordClose(c);
+#endif
     FreeInternal(c);
-    c->callbacks->freeMemory(c->instanceName);
-    for (i = 0; i < NUMBER_OF_REALS; i++)
+#if FMU_LOG_CAPACITY > 0
+    LogClose(c);
+#endif
+#if FMU_POOL_SIZE > 0
+    if (PoolPut(c))
     {
-        c->callbacks->freeMemory(c->reals[i]);
+        return;
     }
-    c->callbacks->freeMemory(c->reals);
-    c->callbacks->freeMemory(c->integers);
-    c->callbacks->freeMemory(c->booleans);
-    c->callbacks->freeMemory(c->strings);
-    c->callbacks->freeMemory(component);
+#endif
+    c->freeMemory(c);
 }
 
 fmi2Status fmi2SetupExperiment
@@ -216,6 +1100,12 @@ fmi2Status fmi2SetupExperiment
     {
         return fmi2Fatal;
     }
+#ifdef FMU_RECORD
+    {
+        struct RecordExperiment experiment = {toleranceDefined, stopTimeDefined, tolerance, startTime, stopTime};
+        RECORD(RecordSetupExperiment, 0, &experiment, sizeof(experiment), NULL, NULL, NULL);
+    }
+#endif
     c->startTime = startTime;
     logf(fmi2OK, "fmi2SetupExperiment startTime = %lf", startTime);
     c->time = startTime;
@@ -228,6 +1118,7 @@ fmi2Status fmi2SetupExperiment
         c->stopTime = stopTime;
         logf(fmi2OK, "stopTime = %lf", stopTime);
     }
+    c->toleranceDefined = toleranceDefined;
     if (toleranceDefined)
     {
         c->tolerance = tolerance;
@@ -247,18 +1138,50 @@ fmi2Status fmi2EnterInitializationMode(fmi2Component component)
         return fmi2Fatal;
     }
     log(fmi2OK, "fmi2EnterInitializationMode");
+    RECORD(RecordEnterInitializationMode, 0, NULL, 0, NULL, NULL, NULL);
     StartInitialization(component);
     return fmi2OK;
 }
 
 fmi2Status fmi2ExitInitializationMode(fmi2Component component)
 {
+    fmi2Status status;
     if (component == NULL)
     {
         return fmi2Fatal;
     }
     log(fmi2OK, "fmi2ExitInitializationMode");
-    return FinishInitialization(component);
+    RECORD(RecordExitInitializationMode, 0, NULL, 0, NULL, NULL, NULL);
+    TRACE_BEGIN("FinishInitialization");
+    status = FinishInitialization(component);
+    TRACE_END("FinishInitialization");
+#if FMU_LOG_CAPACITY > 0
+    LogFlush(component);
+#endif
+    return status;
+}
+
+static void StatisticsAddDoStepTime(fmi2Component component, fmi2Real time)
+{
+    struct Statistics* statistics = &_this->statistics;
+    fmi2Real microseconds = time * 1e6;
+    size_t bin = 0;
+    while (microseconds >= 1. && bin < STATISTICS_HISTOGRAM_BINS - 1)
+    {
+        microseconds *= 0.5;
+        bin++;
+    }
+    statistics->doStepHistogram[bin]++;
+    statistics->doStepTime += time;
+    statistics->doStepLastTime = time;
+    if (statistics->doSteps == 1 || time < statistics->doStepMinTime)
+    {
+        statistics->doStepMinTime = time;
+    }
+    if (time > statistics->doStepMaxTime)
+    {
+        statistics->doStepMaxTime = time;
+    }
 }
 
 fmi2Status fmi2DoStep
@@ -267,16 +1190,35 @@ fmi2Status fmi2DoStep
   , fmi2Real communicationStepSize
   , fmi2Boolean noSetFMUStatePriorToCurrentPoint)
 {
+    fmi2Real start;
+    fmi2Status status;
     if (component == NULL)
     {
         return fmi2Fatal;
     }
-    if (StateUpdate(component, communicationStepSize) != fmi2OK)
+    TRACE_BEGIN("fmi2DoStep");
+#ifdef FMU_RECORD
     {
-        return fmi2Error;
+        struct RecordStep step = {currentCommunicationPoint, communicationStepSize, noSetFMUStatePriorToCurrentPoint, 0};
+        RECORD(RecordDoStep, 0, &step, sizeof(step), NULL, NULL, NULL);
     }
-    _t += communicationStepSize;
-    return fmi2OK;
+#endif
+    start = Now();
+    _this->statistics.doSteps++;
+    TRACE_BEGIN("StateUpdate");
+    status = StateUpdate(component, communicationStepSize) == fmi2OK ? fmi2OK : fmi2Error;
+    TRACE_END("StateUpdate");
+    if (status == fmi2OK)
+    {
+        _t += communicationStepSize;
+    }
+    _this->statistics.doStepStatus = status;
+    StatisticsAddDoStepTime(component, Now() - start);
+#if FMU_LOG_CAPACITY > 0
+    LogFlush(component);
+#endif
+    TRACE_END("fmi2DoStep");
+    return status;
 }
 
 fmi2Status fmi2GetReal
@@ -286,19 +1228,28 @@ fmi2Status fmi2GetReal
     , fmi2Real value[])
 {
     size_t i;
+    fmi2Status status;
     if (component == NULL)
     {
         return fmi2Fatal;
     }
-	if (OutputUpdate(component) != fmi2OK)
+    TRACE_BEGIN("fmi2GetReal");
+    TRACE_BEGIN("OutputUpdate");
+    status = OutputUpdate(component);
+    TRACE_END("OutputUpdate");
+	if (status != fmi2OK)
 	{
+        TRACE_END("fmi2GetReal");
 		return fmi2Error;
 	}
+    _this->statistics.getReals += nvr;
     for (i = 0; i < nvr; i++)
     {
         value[i] = r(vr[i],0);
         logf(fmi2OK, "fmi2GetReal vr = %d, value = %lf", vr[i], value[i]);
     }
+    RECORD(RecordGetReal, nvr, NULL, 0, value, vr, NULL);
+    TRACE_END("fmi2GetReal");
     return fmi2OK;
 }
 
@@ -367,11 +1318,15 @@ fmi2Status fmi2SetReal
     {
         return fmi2Fatal;
     }
+    TRACE_BEGIN("fmi2SetReal");
+    RECORD(RecordSetReal, nvr, NULL, 0, value, vr, NULL);
+    _this->statistics.setReals += nvr;
     for (i = 0; i < nvr; i++)
     {
         logf(fmi2OK, "fmi2SetReal vr = %d, value = %lf", vr[i], value[i]);
         r(vr[i],0) = value[i];
     }
+    TRACE_END("fmi2SetReal");
     return fmi2OK;
 }
 
@@ -386,6 +1341,7 @@ fmi2Status fmi2SetInteger
     {
         return fmi2Fatal;
     }
+    RECORD(RecordSetInteger, nvr, NULL, 0, NULL, vr, value);
     for (i = 0; i < nvr; i++)
     {
         i(vr[i]) = value[i];
@@ -404,6 +1360,7 @@ fmi2Status fmi2SetBoolean
     {
         return fmi2Fatal;
     }
+    RECORD(RecordSetBoolean, nvr, NULL, 0, NULL, vr, value);
     for (i = 0; i < nvr; i++)
     {
         b(vr[i]) = value[i];
@@ -425,6 +1382,167 @@ fmi2Status fmi2SetString
     return fmi2OK;
 }
 
+fmi2Status fmi2GetFMUstate(fmi2Component component, fmi2FMUstate* FMUstate)
+{
+    struct Component* c = component;
+    struct State* state;
+    size_t size;
+    if (component == NULL)
+    {
+        return fmi2Fatal;
+    }
+    size = StateSize(NUMBER_OF_INTERNAL_STATES);
+    state = *FMUstate;
+    if (state != NULL && state->size != size)
+    {
+        c->callbacks->freeMemory(state);
+        state = NULL;
+    }
+    if (state == NULL)
+    {
+        state = c->callbacks->allocateMemory(1, size);
+        if (state == NULL)
+        {
+            log(fmi2Error, "fmi2GetFMUstate could not allocate the state");
+            return fmi2Error;
+        }
+    }
+    state->magic = STATE_MAGIC;
+    state->version = STATE_VERSION;
+    state->size = size;
+    state->numberOfInternalStates = NUMBER_OF_INTERNAL_STATES;
+    state->time = c->time;
+    memcpy(state->guid, c->guid, GUID_SIZE);
+    memcpy(STATE_REALS(state), c->reals, NUMBER_OF_REALS * (MAX_INPUT_DERIVATIVE_ORDER + 1) * sizeof(fmi2Real));
+    SaveInternal(component, STATE_INTERNAL(state));
+    memcpy(STATE_INTEGERS(state), c->integers, NUMBER_OF_INTEGERS * sizeof(fmi2Integer));
+    memcpy(STATE_BOOLEANS(state), c->booleans, NUMBER_OF_BOOLEANS * sizeof(fmi2Boolean));
+    *FMUstate = state;
+    logf(fmi2OK, "fmi2GetFMUstate time = %lf", state->time);
+    RECORD_STATE(RecordGetFMUstate, state);
+    return fmi2OK;
+}
+
+fmi2Status fmi2SetFMUstate(fmi2Component component, fmi2FMUstate FMUstate)
+{
+    struct Component* c = component;
+    struct State* state = FMUstate;
+    if (component == NULL)
+    {
+        return fmi2Fatal;
+    }
+    if (state == NULL || !StateBelongs(component, state) || state->numberOfInternalStates != NUMBER_OF_INTERNAL_STATES)
+    {
+        log(fmi2Error, "fmi2SetFMUstate state does not belong to this model");
+        return fmi2Error;
+    }
+    logf(fmi2OK, "fmi2SetFMUstate time = %lf", state->time);
+    RECORD_STATE(RecordSetFMUstate, state);
+    c->time = state->time;
+    memcpy(c->reals, STATE_REALS(state), NUMBER_OF_REALS * (MAX_INPUT_DERIVATIVE_ORDER + 1) * sizeof(fmi2Real));
+    memcpy(c->integers, STATE_INTEGERS(state), NUMBER_OF_INTEGERS * sizeof(fmi2Integer));
+    memcpy(c->booleans, STATE_BOOLEANS(state), NUMBER_OF_BOOLEANS * sizeof(fmi2Boolean));
+    return RestoreInternal(component, STATE_INTERNAL(state));
+}
+
+fmi2Status fmi2FreeFMUstate(fmi2Component component, fmi2FMUstate* FMUstate)
+{
+    struct Component* c = component;
+    if (component == NULL)
+    {
+        return fmi2Fatal;
+    }
+    if (*FMUstate != NULL)
+    {
+        RECORD_STATE(RecordFreeFMUstate, *FMUstate);
+        c->callbacks->freeMemory(*FMUstate);
+        *FMUstate = NULL;
+    }
+    return fmi2OK;
+}
+
+fmi2Status fmi2SerializedFMUstateSize(fmi2Component component, fmi2FMUstate FMUstate, size_t* size)
+{
+    struct State* state = FMUstate;
+    if (component == NULL)
+    {
+        return fmi2Fatal;
+    }
+    if (state == NULL)
+    {
+        return fmi2Error;
+    }
+    *size = state->size;
+    return fmi2OK;
+}
+
+fmi2Status fmi2SerializeFMUstate
+    ( fmi2Component component
+    , fmi2FMUstate FMUstate
+    , fmi2Byte serializedState[]
+    , size_t size)
+{
+    struct State* state = FMUstate;
+    if (component == NULL)
+    {
+        return fmi2Fatal;
+    }
+    if (state == NULL || size < state->size)
+    {
+        log(fmi2Error, "fmi2SerializeFMUstate buffer is too small");
+        return fmi2Error;
+    }
+    memcpy(serializedState, state, state->size);
+    return fmi2OK;
+}
+
+fmi2Status fmi2DeSerializeFMUstate
+    ( fmi2Component component
+    , const fmi2Byte serializedState[]
+    , size_t size
+    , fmi2FMUstate* FMUstate)
+{
+    struct Component* c = component;
+    struct State header;
+    struct State* state;
+    if (component == NULL)
+    {
+        return fmi2Fatal;
+    }
+    if (size < sizeof(struct State))
+    {
+        log(fmi2Error, "fmi2DeSerializeFMUstate serialized state is too small");
+        return fmi2Error;
+    }
+    memcpy(&header, serializedState, sizeof(struct State));
+    if (!StateBelongs(component, &header) || header.size != size || header.size != StateSize(header.numberOfInternalStates))
+    {
+        log(fmi2Error, "fmi2DeSerializeFMUstate serialized state does not belong to this model");
+        return fmi2Error;
+    }
+    state = *FMUstate;
+    if (state != NULL && state->size != size)
+    {
+        c->callbacks->freeMemory(state);
+        state = NULL;
+    }
+    if (state == NULL)
+    {
+        state = c->callbacks->allocateMemory(1, size);
+        if (state == NULL)
+        {
+            log(fmi2Error, "fmi2DeSerializeFMUstate could not allocate the state");
+            return fmi2Error;
+        }
+    }
+    memcpy(state, serializedState, size);
+    *FMUstate = state;
+#ifdef FMU_RECORD
+    RecordDeSerialize(component, state, serializedState, size);
+#endif
+    return fmi2OK;
+}
+
 fmi2Status fmi2SetRealInputDerivatives
     ( fmi2Component component
     , const fmi2ValueReference vr[]
@@ -437,11 +1555,15 @@ fmi2Status fmi2SetRealInputDerivatives
     {
         return fmi2Fatal;
     }
+    TRACE_BEGIN("fmi2SetRealInputDerivatives");
+    RECORD(RecordSetRealInputDerivatives, nvr, NULL, 0, value, vr, dvr);
+    _this->statistics.setRealInputDerivatives += nvr;
     for (i = 0; i < nvr; i++)
     {
         if (dvr[i] < 1 || dvr[i] > MAX_INPUT_DERIVATIVE_ORDER)
         {
             logf(fmi2Error, "fmi2SetRealInputDerivatives vr = %d, d = %d, value = %lf", vr[i], dvr[i], value[i]);
+            TRACE_END("fmi2SetRealInputDerivatives");
             return fmi2Error;
         }
         else
@@ -450,9 +1572,15 @@ fmi2Status fmi2SetRealInputDerivatives
             r(vr[i],dvr[i]) = value[i];
         }
     }
+    TRACE_END("fmi2SetRealInputDerivatives");
     return fmi2OK;
 }
 
+/*
+ * The derivatives at the current communication point, i.e. local Taylor
+ * coefficients. CVODE models take them from the polynomial of their last
+ * internal step, which covers only the end of the communication step.
+ */
 fmi2Status fmi2GetRealOutputDerivatives
     ( fmi2Component component
     , const fmi2ValueReference vr[]
@@ -461,10 +1589,26 @@ fmi2Status fmi2GetRealOutputDerivatives
     , fmi2Real value[])
 {
     size_t i;
+    if (component == NULL)
+    {
+        return fmi2Fatal;
+    }
     for (i = 0; i < nvr; i++)
     {
-        return fmi2Error;
+        if (dvr[i] < 1 || dvr[i] > MAX_OUTPUT_DERIVATIVE_ORDER)
+        {
+            logf(fmi2Error, "fmi2GetRealOutputDerivatives vr = %d, d = %d", vr[i], dvr[i]);
+            return fmi2Error;
+        }
+#if MAX_OUTPUT_DERIVATIVE_ORDER > 0
+        if (OutputDerivative(component, vr[i], dvr[i], &value[i]) != fmi2OK)
+        {
+            return fmi2Error;
+        }
+        logf(fmi2OK, "fmi2GetRealOutputDerivatives vr = %d, d = %d, value = %lf", vr[i], dvr[i], value[i]);
+#endif
     }
+    RECORD(RecordGetRealOutputDerivatives, nvr, NULL, 0, value, vr, dvr);
     return fmi2OK;
 }
 
@@ -478,7 +1622,15 @@ fmi2Status fmi2GetStatus
     , const fmi2StatusKind status
     , fmi2Status* value)
 {
-    *value = fmi2OK;
+    if (component == NULL)
+    {
+        return fmi2Fatal;
+    }
+    if (status != fmi2DoStepStatus)
+    {
+        return fmi2Discard;
+    }
+    *value = _this->statistics.doStepStatus;
     return fmi2OK;
 }
 
@@ -487,7 +1639,41 @@ fmi2Status fmi2GetRealStatus
     , const fmi2StatusKind status
     , fmi2Real* value)
 {
-    return fmi2OK;
+    if (component == NULL)
+    {
+        return fmi2Fatal;
+    }
+    switch ((int)status)
+    {
+    case fmi2LastSuccessfulTime:
+        *value = _t;
+        return fmi2OK;
+    case StatisticsDoStepTime:
+        *value = _this->statistics.doStepTime;
+        return fmi2OK;
+    case StatisticsDoStepLastTime:
+        *value = _this->statistics.doStepLastTime;
+        return fmi2OK;
+    case StatisticsDoStepMinTime:
+        *value = _this->statistics.doStepMinTime;
+        return fmi2OK;
+    case StatisticsDoStepMaxTime:
+        *value = _this->statistics.doStepMaxTime;
+        return fmi2OK;
+    case StatisticsStateDerivativeNorm:
+#if HAS_STATE_DERIVATIVE_NORM
+        return StateDerivativeNorm(component, value) == fmi2OK ? fmi2OK : fmi2Discard;
+#else
+        if (NUMBER_OF_INTERNAL_STATES > 0)
+        {
+            return fmi2Discard;
+        }
+        *value = 0.;
+        return fmi2OK;
+#endif
+    default:
+        return fmi2Discard;
+    }
 }
 
 fmi2Status fmi2GetIntegerStatus
@@ -495,7 +1681,58 @@ fmi2Status fmi2GetIntegerStatus
     , const fmi2StatusKind status
     , fmi2Integer* value)
 {
-    return fmi2OK;
+#if HAS_INTEGRATOR_STATISTICS
+    struct IntegratorStatistics integrator;
+#endif
+    if (component == NULL)
+    {
+        return fmi2Fatal;
+    }
+    switch ((int)status)
+    {
+    case StatisticsDoSteps:
+        *value = (fmi2Integer)_this->statistics.doSteps;
+        return fmi2OK;
+    case StatisticsGetReals:
+        *value = (fmi2Integer)_this->statistics.getReals;
+        return fmi2OK;
+    case StatisticsSetReals:
+        *value = (fmi2Integer)_this->statistics.setReals;
+        return fmi2OK;
+    case StatisticsSetRealInputDerivatives:
+        *value = (fmi2Integer)_this->statistics.setRealInputDerivatives;
+        return fmi2OK;
+    }
+    if ((int)status >= StatisticsDoStepHistogram && (int)status < StatisticsDoStepHistogram + STATISTICS_HISTOGRAM_BINS)
+    {
+        *value = (fmi2Integer)_this->statistics.doStepHistogram[(int)status - StatisticsDoStepHistogram];
+        return fmi2OK;
+    }
+#if HAS_INTEGRATOR_STATISTICS
+    if (IntegratorStatistics(component, &integrator) != fmi2OK)
+    {
+        return fmi2Discard;
+    }
+    switch ((int)status)
+    {
+    case StatisticsIntegratorSteps:
+        *value = (fmi2Integer)integrator.steps;
+        return fmi2OK;
+    case StatisticsRhsEvaluations:
+        *value = (fmi2Integer)integrator.rhsEvaluations;
+        return fmi2OK;
+    case StatisticsJacobianEvaluations:
+        *value = (fmi2Integer)integrator.jacobianEvaluations;
+        return fmi2OK;
+    case StatisticsNewtonIterations:
+        *value = (fmi2Integer)integrator.newtonIterations;
+        return fmi2OK;
+    case StatisticsErrorTestFailures:
+        *value = (fmi2Integer)integrator.errorTestFailures;
+        return fmi2OK;
+    }
+#endif
+    return fmi2Discard;
 }
 
 fmi2Status fmi2GetBooleanStatus
@@ -503,6 +1740,15 @@ fmi2Status fmi2GetBooleanStatus
     , const fmi2StatusKind status
     , fmi2Boolean* value)
 {
+    if (component == NULL)
+    {
+        return fmi2Fatal;
+    }
+    if (status != fmi2Terminated)
+    {
+        return fmi2Discard;
+    }
+    *value = fmi2False;
     return fmi2OK;
 }
 
@@ -511,6 +1757,29 @@ fmi2Status fmi2GetStringStatus
     , const fmi2StatusKind status
     , fmi2String* value)
 {
+    return fmi2Discard;
+}
+
+/*
+ * Extension to FMI 2.0: announces the time of the next discontinuity of the
+ * outputs after the current time, so the master can place a communication
+ * point exactly on it. defined is fmi2False if no event is known. The fmi2
+ * prefix is reserved for the standard, so extensions use fmu.
+ */
+FMI2_Export fmi2Status fmuGetNextEventTime
+    ( fmi2Component component
+    , fmi2Boolean* defined
+    , fmi2Real* nextEventTime)
+{
+    if (component == NULL)
+    {
+        return fmi2Fatal;
+    }
+#if HAS_TIME_EVENTS
+    *defined = NextEventTime(component, nextEventTime);
+#else
+    *defined = fmi2False;
+#endif
     return fmi2OK;
 }
 